@@ -26,7 +26,25 @@
 #include "Components/StaticMeshComponent.h"
 #include "Components/ArrowComponent.h"
 #include "Components/SkyAtmosphereComponent.h"
+#include "Components/SkyLightComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StreamableManager.h"
+#include "EngineUtils.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Engine.h"
+#include "Net/UnrealNetwork.h"
+#include "SimpleDayNightConfigWriter.h"
+#include "SimpleDayNightStats.h"
 
 #include "Misc/ConfigCacheIni.h"
 #include "Misc/ConfigUtilities.h"
@@ -56,6 +74,127 @@ static TAutoConsoleVariable<float> CVarStepRate(
 	TEXT("Number of seconds between updates when not using Smoothed sun update")
 );
 
+static TAutoConsoleVariable<int32> CVarThresholdUpdate(
+	TEXT("sdn.ThresholdUpdate"),
+	0,
+	TEXT("Sets whether to only update the sun position once it has moved more than sdn.AngleThreshold degrees. Overrides sdn.SmoothTime")
+);
+
+static TAutoConsoleVariable<float> CVarAngleThreshold(
+	TEXT("sdn.AngleThreshold"),
+	0.1f,
+	TEXT("Number of degrees the sun has to move before its position is updated when using threshold sun update")
+);
+
+static TAutoConsoleVariable<int32> CVarCommitScheduler(
+	TEXT("sdn.CommitScheduler"),
+	1,
+	TEXT("Sets whether stepped and threshold sun updates wait for a frame with headroom before updating the sun position")
+);
+
+static TAutoConsoleVariable<int32> CVarMaxDeferFrames(
+	TEXT("sdn.MaxDeferFrames"),
+	8,
+	TEXT("Maximum number of frames a scheduled sun update can be held back")
+);
+
+static TAutoConsoleVariable<float> CVarMaxLagAngle(
+	TEXT("sdn.MaxLagAngle"),
+	1.0f,
+	TEXT("Maximum number of degrees the sun may lag behind its real position before a scheduled sun update is forced")
+);
+
+static TAutoConsoleVariable<int32> CVarCacheKeysPerDay(
+	TEXT("sdn.CacheKeysPerDay"),
+	96,
+	TEXT("Number of precomputed sun and star orientations per in-game day. 0 disables the orientation cache")
+);
+
+static TAutoConsoleVariable<float> CVarTickInterval(
+	TEXT("sdn.TickInterval"),
+	0.0f,
+	TEXT("Number of seconds between clock updates, which is how often events fire and snapshots are published. 0 updates every frame")
+);
+
+static TAutoConsoleVariable<float> CVarSkyLightBudget(
+	TEXT("sdn.SkyLightBudget"),
+	2.0f,
+	TEXT("Milliseconds a SkyLight recapture may add to its frame. The capture resolution is adjusted to fit")
+);
+
+static TAutoConsoleVariable<float> CVarStarMagnitudeLimit(
+	TEXT("sdn.StarMagnitudeLimit"),
+	6.5f,
+	TEXT("Faintest star drawn from the binary star catalog. Higher shows more stars")
+);
+
+static TAutoConsoleVariable<float> CVarTickPixels(
+	TEXT("sdn.TickPixels"),
+	0.5f,
+	TEXT("Most pixels the sky may move across the screen between controller ticks. The controller ticks only as often as that needs. 0 ticks every frame")
+);
+
+//Every sdn.* CVar and the controller property it's linked to
+static const TArray<TPair<IConsoleVariable*, FName>>& GetLinkedCVars()
+{
+	static const TArray<TPair<IConsoleVariable*, FName>> LinkedCVars = {
+		{ CVarSmoothTime.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, SmoothTime) },
+		{ CVarDayLength.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, LengthOfDay) },
+		{ CVarSeasonLength.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, SeasonLength) },
+		{ CVarStepRate.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, SteppedTimeRate) },
+		{ CVarThresholdUpdate.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, ThresholdUpdate) },
+		{ CVarAngleThreshold.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, SunAngleThreshold) },
+		{ CVarCommitScheduler.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, CommitScheduler) },
+		{ CVarMaxDeferFrames.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, MaxDeferFrames) },
+		{ CVarMaxLagAngle.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, MaxLagAngle) },
+		{ CVarCacheKeysPerDay.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, OrientationCacheKeys) },
+		{ CVarTickInterval.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, ClockTickInterval) },
+		{ CVarSkyLightBudget.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, SkyLightBudget) },
+		{ CVarStarMagnitudeLimit.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, StarMagnitudeLimit) },
+		{ CVarTickPixels.AsVariable(), GET_MEMBER_NAME_CHECKED(ADayNightController, TickPixelThreshold) }
+	};
+	return LinkedCVars;
+}
+
+static FAutoConsoleCommandWithWorld CacheErrorCommand(
+	TEXT("sdn.CacheError"),
+	TEXT("Logs the largest angular error of the orientation cache against the analytic sky math, for every DayNightController in the world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		for (TActorIterator<ADayNightController> It(World); It; ++It)
+		{
+			const FSimpleDayNightEphemerisParams Params = It->GetEphemerisParams();
+			for (int32 KeysPerDay : { 24, 48, 96, 192, 384 })
+			{
+				UE_LOG(LogTemp, Log, TEXT("%s: %d keys per day, max error %.6f degrees"),
+					*It->GetName(), KeysPerDay, FSimpleDayNightOrientationCache::MeasureMaxAngularError(Params, It->GetClock().Day, KeysPerDay));
+			}
+		}
+	})
+);
+
+static FAutoConsoleCommandWithWorld FrameStatsCommand(
+	TEXT("sdn.FrameStats"),
+	TEXT("Logs frame time percentiles and scheduled sun update counts for every DayNightController in the world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		for (TActorIterator<ADayNightController> It(World); It; ++It)
+		{
+			const FSimpleDayNightCommitScheduler& Scheduler = It->GetSunCommitScheduler();
+			UE_LOG(LogTemp, Log, TEXT("%s: p50 %.2fms p90 %.2fms p99 %.2fms, %lld commits, %lld skipped, %lld deferred (%lld frames), %lld forced"),
+				*It->GetName(),
+				Scheduler.GetFrameTimePercentile(50.0f) * 1000.0f,
+				Scheduler.GetFrameTimePercentile(90.0f) * 1000.0f,
+				Scheduler.GetFrameTimePercentile(99.0f) * 1000.0f,
+				It->SunCommits,
+				It->SkippedSunCommits,
+				Scheduler.GetDeferredCommits(),
+				Scheduler.GetDeferredFrames(),
+				Scheduler.GetForcedCommits());
+		}
+	})
+);
+
 
 // Sets default values
 ADayNightController::ADayNightController(const FObjectInitializer& ObjectInitializer)
@@ -63,201 +202,1526 @@ ADayNightController::ADayNightController(const FObjectInitializer& ObjectInitial
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	//Only the clock epoch and rate replicate, and only when they change, so there's no need to check often.
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	NetUpdateFrequency = 1.0f;
+
 	Root = CreateDefaultSubobject< USceneComponent > (TEXT("Root"));
 	RootComponent = Root;
 
 	Axis = CreateDefaultSubobject<USceneComponent>(TEXT("Axis"));
 	Axis->SetupAttachment(Root);
 
-	Sun = CreateDefaultSubobject<UDirectionalLightComponent>(TEXT("Sun"));
-	Sun->SetupAttachment(Axis);
+	//Nobody sees the sky on a dedicated server or with -nullrhi, so don't create (or load) anything for it. The clock still runs.
+	bHeadless = !ShouldCreateVisualComponents();
 
-	SkySphere = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("SkySphere"));
-	SkySphere->SetupAttachment(Root);
-	UStaticMesh* Sky = LoadObject<UStaticMesh>(nullptr, TEXT("/Simple_DayNight/Skysphere_Full.SkySphere_Full"));
-	
-	SkySphere->SetStaticMesh(Sky);
-	SkySphere->SetWorldScale3D(FVector(100000, 100000, 100000));
+	if (!bHeadless)
+	{
+		Sun = CreateDefaultSubobject<UDirectionalLightComponent>(TEXT("Sun"));
+		Sun->SetupAttachment(Axis);
 
-	Atmosphere = CreateDefaultSubobject<USkyAtmosphereComponent>(TEXT("Atmosphere"));
-	Atmosphere->SetupAttachment(Root);
+		//The mesh and its 4K star texture are loaded in the background later, not for the CDO and every spawn.
+		//Transient, so levels only save SkySphereMesh and SkySphereMaterial and never a hard reference to what was loaded from them.
+		SkySphere = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("SkySphere"), true);
+		SkySphere->SetupAttachment(Root);
+		SkySphere->SetWorldScale3D(FVector(100000, 100000, 100000));
+
+		//Nothing to draw until a catalog is loaded. Transient too, its mesh comes from StarMesh and its instances from the catalog.
+		StarField = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("StarField"), true);
+		StarField->SetupAttachment(Root);
+		StarField->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		StarField->SetCastShadow(false);
+		StarField->NumCustomDataFloats = 2;
+		StarField->SetVisibility(false);
+
+		Atmosphere = CreateDefaultSubobject<USkyAtmosphereComponent>(TEXT("Atmosphere"));
+		Atmosphere->SetupAttachment(Root);
+
+		//Second atmosphere light, so the sky picks up moonlight at night. Dark until the first sun commit places it.
+		MoonLight = CreateDefaultSubobject<UDirectionalLightComponent>(TEXT("MoonLight"));
+		MoonLight->SetupAttachment(Root);
+		MoonLight->bAtmosphereSunLight = true;
+		MoonLight->AtmosphereSunLightIndex = 1;
+		MoonLight->Intensity = 0.0f;
+		MoonLight->LightColor = FColor(190, 210, 255);
+
+		//A second shadow casting directional light would double the Virtual Shadow Map cost. Turn it on in the editor if the moon needs shadows.
+		MoonLight->SetCastShadows(false);
+
+		//Captured on demand rather than in real time, see UpdateSkyLight.
+		SkyLight = CreateDefaultSubobject<USkyLightComponent>(TEXT("SkyLight"));
+		SkyLight->SetupAttachment(Root);
+		SkyLight->SetMobility(EComponentMobility::Movable);
+		SkyLight->bRealTimeCapture = false;
+		SkyLight->SourceType = SLS_CapturedScene;
+		SkyLight->SetVisibility(false);
+	}
 
 	//Set the properties that are linked to CVars to the CVar values (aka what's in DefaultSimpleDayNight.ini)
 	SmoothTime = (bool)CVarSmoothTime.GetValueOnAnyThread();
 	SeasonLength = CVarSeasonLength.GetValueOnAnyThread();
 	LengthOfDay = CVarDayLength.GetValueOnAnyThread();
 	SteppedTimeRate = CVarStepRate.GetValueOnAnyThread();
+	ThresholdUpdate = (bool)CVarThresholdUpdate.GetValueOnAnyThread();
+	SunAngleThreshold = CVarAngleThreshold.GetValueOnAnyThread();
+	CommitScheduler = (bool)CVarCommitScheduler.GetValueOnAnyThread();
+	MaxDeferFrames = CVarMaxDeferFrames.GetValueOnAnyThread();
+	MaxLagAngle = CVarMaxLagAngle.GetValueOnAnyThread();
+	OrientationCacheKeys = CVarCacheKeysPerDay.GetValueOnAnyThread();
+	ClockTickInterval = CVarTickInterval.GetValueOnAnyThread();
+	SkyLightBudget = CVarSkyLightBudget.GetValueOnAnyThread();
+	StarMagnitudeLimit = CVarStarMagnitudeLimit.GetValueOnAnyThread();
+	TickPixelThreshold = CVarTickPixels.GetValueOnAnyThread();
 
 	//Load the config to overwrite any properties that aren't defaults
 	LoadConfig();
 
-	//Update Sun and Star positions for the loaded properties.
+	SyncClock();
+	OrientationCache.SetKeysPerDay(OrientationCacheKeys);
+
+	SkySphereMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Simple_DayNight/SkySphere_Full.SkySphere_Full")));
+}
+
+void ADayNightController::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	if (SkyLight)
+	{
+		SkyLight->SetVisibility(ManageSkyLight);
+	}
+
+#if WITH_EDITORONLY_DATA
+	//PostEditChangeProperty moves the sky itself while dragging.
+	if (bEditorDragging)
+	{
+		return;
+	}
+#endif
+
+	BakeSkyCurves();
+	UpdateSkyBodyParameterNames();
+
+	//Update Sun and Star positions for the loaded properties, so the editor shows the right sky.
 	UpdateSunPosition();
 	UpdateStarPosition();
-}
 
-//If we're running in editor we want to save any changes to the properties to the DefaultSimpleDayNight.ini
 #if WITH_EDITOR
-void ADayNightController::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
-{
-	Super::PostEditChangeProperty(PropertyChangedEvent);
+	UpdatePreviewFromClock();
+#endif
 
-	FName PropertyName = (PropertyChangedEvent.GetPropertyName());
+	RequestSkySphereLoad();
+}
 
-	UE_LOG(LogTemp, Log, TEXT("%s changed"), *PropertyName.ToString());
+void ADayNightController::RequestSkySphereLoad()
+{
+	if (!SkySphere || SkySphereLoadHandle.IsValid())
+	{
+		return;
+	}
 
-	if (PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, Latitude) ||
-		PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, TimeOfDay) ||
-		PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, AxialTilt))
+	const bool bNeedsMesh = !SkySphereMesh.IsNull() && SkySphere->GetStaticMesh() != SkySphereMesh.Get();
+	const bool bNeedsMaterial = !SkySphereMaterial.IsNull() && SkySphere->GetMaterial(0) != SkySphereMaterial.Get();
+	const bool bNeedsStarMesh = StarField && !StarMesh.IsNull() && StarField->GetStaticMesh() != StarMesh.Get();
+	const bool bNeedsStarMaterial = StarField && !StarMaterial.IsNull() && StarField->GetMaterial(0) != StarMaterial.Get();
+	if (!bNeedsMesh && !bNeedsMaterial && !bNeedsStarMesh && !bNeedsStarMaterial)
 	{
-		UpdateSunPosition();
-		UpdateStarPosition();
+		return;
 	}
-	
-	if (PropertyChangedEvent.Property)
+
+	TArray<FSoftObjectPath> Paths;
+	if (!SkySphereMesh.IsNull())
 	{
-		SaveConfig(CPF_Config, *GetDefaultConfigFilename());
+		Paths.Add(SkySphereMesh.ToSoftObjectPath());
 	}
+	if (!SkySphereMaterial.IsNull())
+	{
+		Paths.Add(SkySphereMaterial.ToSoftObjectPath());
+	}
+	if (StarField && !StarMesh.IsNull())
+	{
+		Paths.Add(StarMesh.ToSoftObjectPath());
+	}
+	if (StarField && !StarMaterial.IsNull())
+	{
+		Paths.Add(StarMaterial.ToSoftObjectPath());
+	}
+
+	//Calls straight back if they're already loaded.
+	SkySphereLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Paths, FStreamableDelegate::CreateUObject(this, &ADayNightController::OnSkySphereLoaded));
 }
-#endif
 
-// Called when the game starts or when spawned
-void ADayNightController::BeginPlay()
+void ADayNightController::OnSkySphereLoaded()
 {
-	Super::BeginPlay();
+	SkySphereLoadHandle.Reset();
 
-	//Update CVars to match locally overridden values.
-	//For some reason in a build this will throw an exception and crash if done in PostInitProperties()
-	CVarSmoothTime.AsVariable()->Set(SmoothTime, ECVF_SetByProjectSetting);
-	CVarSeasonLength.AsVariable()->Set(SeasonLength, ECVF_SetByProjectSetting);
-	CVarDayLength.AsVariable()->Set(LengthOfDay, ECVF_SetByProjectSetting);
-	CVarStepRate.AsVariable()->Set(SteppedTimeRate, ECVF_SetByProjectSetting);
+	if (!SkySphere)
+	{
+		return;
+	}
 
-	FAutoConsoleVariableSink TimeSink(FConsoleCommandDelegate::CreateUObject(this, &ADayNightController::SmoothSinkFunction));
+	if (UStaticMesh* Mesh = SkySphereMesh.Get())
+	{
+		SkySphere->SetStaticMesh(Mesh);
+	}
+	if (UMaterialInterface* Material = SkySphereMaterial.Get())
+	{
+		SkySphere->SetMaterial(0, Material);
+	}
 
-	if (!SmoothTime)
+	if (StarField)
 	{
-		FTimerDelegate TimerDelegate = FTimerDelegate::CreateUObject(this, &ADayNightController::UpdateSunPositionTimer);
-		GetWorldTimerManager().SetTimer(SteppedTimerHandle, TimerDelegate, SteppedTimeRate, true);
+		if (UStaticMesh* Mesh = StarMesh.Get())
+		{
+			StarField->SetStaticMesh(Mesh);
+		}
+		if (UMaterialInterface* Material = StarMaterial.Get())
+		{
+			StarField->SetMaterial(0, Material);
+		}
 	}
-	
 }
 
-// Called every frame
-void ADayNightController::Tick(float DeltaTime)
+void ADayNightController::LoadStarCatalog()
 {
-	Super::Tick(DeltaTime);	
-
-	TimeOfDay += DeltaTime * (24 / LengthOfDay / 60);
+	StarCatalog.Reset();
+	bStarFieldBuilt = false;
 
-	//Always update star position because it has no effect on performance
-	UpdateStarPosition();
+	if (!StarField || StarCatalogFile.FilePath.IsEmpty())
+	{
+		return;
+	}
 
-	//Only update Sun position on tick if SmoothTime is enabled.
-	if (SmoothTime)
+	const FString Filename = FPaths::IsRelative(StarCatalogFile.FilePath) ? FPaths::ProjectDir() / StarCatalogFile.FilePath : StarCatalogFile.FilePath;
+	if (!StarCatalog.Load(Filename))
 	{
-		UpdateSunPosition();
+		UE_LOG(LogTemp, Warning, TEXT("%s couldn't load the star catalog %s, using the SkySphere's stars"), *GetName(), *Filename);
 	}
 }
 
-void ADayNightController::PostInitProperties()
+void ADayNightController::UpdateStarField()
 {
-	Super::PostInitProperties();
+	//The SkySphere's texture stays until there's a catalog and a mesh to draw its stars with.
+	if (!StarField || !StarCatalog.IsLoaded() || !StarField->GetStaticMesh())
+	{
+		return;
+	}
 
-	
+	FVector3f ViewDirection = FVector3f::ZeroVector;
+	float ViewAngle = 180.0f;
+	if (StarViewCulling)
+	{
+		const APlayerController* PlayerController = GEngine ? GEngine->GetFirstLocalPlayerController(GetWorld()) : nullptr;
+		if (PlayerController && PlayerController->PlayerCameraManager)
+		{
+			//Half the diagonal field of view, and the view direction in the star field's own space since it turns with the sky.
+			const FMinimalViewInfo& View = PlayerController->PlayerCameraManager->GetCameraCacheView();
+			const double AspectRatio = View.AspectRatio > 0.0f ? View.AspectRatio : 16.0 / 9.0;
+			const double HalfTan = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(View.FOV, 1.0f, 170.0f) * 0.5));
+			ViewAngle = (float)FMath::RadiansToDegrees(FMath::Atan(HalfTan * FMath::Sqrt(1.0 + 1.0 / (AspectRatio * AspectRatio))));
+			ViewDirection = FVector3f(StarField->GetComponentQuat().UnrotateVector(View.Rotation.Vector()));
+		}
+	}
 
-}
+	const float KeptAngle = ViewAngle + StarViewMargin;
+	if (KeptAngle >= 180.0f)
+	{
+		ViewDirection = FVector3f::ZeroVector;
+	}
 
-void ADayNightController::UpdateSunPosition()
-{
-	//For some reason I just couldn't get rotating around the component's up vector to work. This math does work.
-	FVector North = FVector(0, -1, 0).RotateAngleAxis(-Latitude, FVector(1, 0, 0));
+	bool bRebuild = !bStarFieldBuilt || StarMagnitudeLimit != BuiltStarMagnitudeLimit || ViewDirection.IsZero() != BuiltStarViewDirection.IsZero();
+	if (!bRebuild && !ViewDirection.IsZero())
+	{
+		//Cull again once the edge of the view gets out of what's kept, or the view has zoomed in far enough that much less would do.
+		const float Offset = (float)FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(ViewDirection | BuiltStarViewDirection, -1.0f, 1.0f)));
+		bRebuild = Offset + ViewAngle > BuiltStarViewAngle || BuiltStarViewAngle > 2.0f * KeptAngle;
+	}
+
+	if (!bRebuild)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_StarFieldRebuild);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADayNightController::UpdateStarField);
+
+	StarCatalog.Cull(StarMagnitudeLimit, ViewDirection, FMath::Cos(FMath::DegreesToRadians(KeptAngle)), StarFieldIndices);
+
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(StarFieldIndices.Num());
+	for (const int32 Index : StarFieldIndices)
+	{
+		//Facing the middle of the sky.
+		const FVector Direction(StarCatalog.GetStar(Index).Direction);
+		Transforms.Emplace(FRotationMatrix::MakeFromX(-Direction).ToQuat(), Direction * StarFieldRadius);
+	}
 
-	FVector East = FVector(1, 0, 0).RotateAngleAxis(TimeOfDay * 15 + 180, North);
+	StarField->ClearInstances();
+	StarField->AddInstances(Transforms, false);
+
+	TArray<float> CustomData;
+	CustomData.SetNum(2);
+	for (int32 Instance = 0; Instance < StarFieldIndices.Num(); ++Instance)
+	{
+		const FSimpleDayNightStarCatalog::FStar Star = StarCatalog.GetStar(StarFieldIndices[Instance]);
+		CustomData[0] = FMath::Pow(10.0f, -0.4f * Star.Magnitude);
+		CustomData[1] = Star.ColorIndex;
+		StarField->SetCustomData(Instance, CustomData, false);
+	}
+	StarField->MarkRenderStateDirty();
 
-	Axis->SetWorldRotation(FRotationMatrix::MakeFromZY(North, East).ToQuat());
+	BuiltStarMagnitudeLimit = StarMagnitudeLimit;
+	BuiltStarViewDirection = ViewDirection;
+	BuiltStarViewAngle = KeptAngle;
+	bStarFieldBuilt = true;
+	StarsShown = StarFieldIndices.Num();
+	StarFieldRebuilds++;
 
-	//Wobble the Sun to fake seasons. Multiply by Pi for more predictable result. Multiply SeasonLength by 2 so SeasonLength=number of days between Solstices and Equinoxes
-	//Clock starts at Northern Winter Solstice.
-	//(I'm treating the orbit as a perfect circle because that's good enough for video games.)
-	Sun->SetRelativeRotation(FRotator(AxialTilt * FMath::Cos(((TimeOfDay-12)/(24*(SeasonLength*2)))*PI), 0, 0));
+	CSV_CUSTOM_STAT(SimpleDayNight, StarsShown, StarsShown, ECsvCustomStatOp::Set);
 
+	if (!StarField->IsVisible())
+	{
+		StarField->SetVisibility(true);
+		if (SkySphere)
+		{
+			SkySphere->SetVisibility(false);
+		}
+		UpdateStarPosition();
+	}
 }
 
-void ADayNightController::UpdateStarPosition()
+//In the editor, changes to Config properties are saved to DefaultSimpleDayNight.ini once they're final
+#if WITH_EDITOR
+void ADayNightController::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
-	FVector North = FVector(0, -1, 0).RotateAngleAxis(-Latitude, FVector(1, 0, 0));
-	
-	//Fake seasonal procession of the stars by doing some math with the calculated seasonal offset.
-	FVector East = FVector(1, 0, 0).RotateAngleAxis((TimeOfDay * 15) +(fmod((TimeOfDay - 12) / (24 * (SeasonLength) * 2), 2)*180) - 90, North); 
-	
-	SkySphere->SetWorldRotation(FRotationMatrix::MakeFromZY(North, East).ToQuat());
+	//Slider drags come through as Interactive on every step, then once more as ValueSet when they end.
+	const bool bInteractive = PropertyChangedEvent.ChangeType == EPropertyChangeType::Interactive;
+
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+
+	const bool bPreview = PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, PreviewHour) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, PreviewSeason) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, PreviewYear);
+	const bool bSkyParams = PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, Latitude) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, AxialTilt) ||
+		PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, SeasonLength);
+
+	if (bPreview)
+	{
+		const double YearLength = FMath::Max(SeasonLength, 0.0f) * 4.0;
+		const double Day = FMath::FloorToDouble(PreviewYear * YearLength + FMath::Clamp(PreviewSeason, 0.0f, 4.0f) * SeasonLength);
+		TimeOfDay = Day * 24.0 + FMath::Clamp(PreviewHour, 0.0f, 24.0f);
+	}
+
+	//Before the construction script reruns, so it commits the sky for the new time.
+	const int64 PreviousDay = Clock.Day;
+	SyncClock();
+	OrientationCache.SetKeysPerDay(OrientationCacheKeys);
+
+	//The orientation cache notices new params by itself, and a new day has to be built anyway, but neither is worth a whole table on every step of a drag.
+	bScrubbing = bInteractive && (bSkyParams || Clock.Day != PreviousDay);
+
+	bEditorDragging = bInteractive;
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	bEditorDragging = false;
+
+	//Edits in PIE show straight away, even on an idle controller.
+	WakeTick();
+
+	//Once the value is set the construction script rerun has already committed the sun and stars, so the sky only needs moving here during a drag.
+	if (bInteractive && (bPreview || bSkyParams || PropertyName == GET_MEMBER_NAME_CHECKED(ADayNightController, TimeOfDay)))
+	{
+		if (!bPreview)
+		{
+			UpdatePreviewFromClock();
+		}
+
+		//Stars don't cast shadows, so they can follow every step. Every sun commit throws away the cached shadow pages, so while dragging it's throttled.
+		UpdateStarPosition();
+
+		const double Now = FPlatformTime::Seconds();
+		if (Now - LastPreviewCommitTime >= PreviewCommitInterval)
+		{
+			LastPreviewCommitTime = Now;
+			UpdateSunPosition();
+		}
+	}
+
+	if (!bInteractive && PropertyChangedEvent.MemberProperty && PropertyChangedEvent.MemberProperty->HasAnyPropertyFlags(CPF_Config))
+	{
+		QueueConfigSave(PropertyName);
+	}
 }
 
-void ADayNightController::UpdateSunPositionTimer()
+void ADayNightController::UpdatePreviewFromClock()
 {
-	UpdateSunPosition();
+	const double YearLength = FMath::Max(SeasonLength, 0.0f) * 4.0;
+	if (YearLength <= 0.0)
+	{
+		PreviewYear = 0;
+		PreviewSeason = 0.0f;
+	}
+	else
+	{
+		PreviewYear = (int32)FMath::Clamp(FMath::FloorToDouble(Clock.Day / YearLength), 0.0, (double)MAX_int32);
+		PreviewSeason = (float)(FMath::Fmod((double)Clock.Day, YearLength) / SeasonLength);
+	}
+	PreviewHour = (float)Clock.Hour;
 }
+#endif
 
-void ADayNightController::SmoothSinkFunction()
-{		
-	bool useSmooth;
+// Called when the game starts or when spawned
+void ADayNightController::BeginPlay()
+{
+	Super::BeginPlay();
 
-	//Only update the class variables if the CVars were last changed by something other than the Project Settings.
-	if ((EConsoleVariableFlags)((uint32)CVarSmoothTime.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting)
-	{		
-		useSmooth = (bool)CVarSmoothTime.GetValueOnAnyThread();
+	//A dedicated server started from the editor still gets the components, since the class was set up for the editor, and a level or
+	//Blueprint saved with them can bring them back on a headless build even though the constructor skipped them. Get rid of them here.
+	if (IsNetMode(NM_DedicatedServer) || !ShouldCreateVisualComponents())
+	{
+		bHeadless = true;
 
-		if (useSmooth != SmoothTime)
+		for (USceneComponent* VisualComponent : TArray<USceneComponent*>{ Sun, MoonLight, SkySphere, StarField, Atmosphere, SkyLight })
 		{
-			//If SmoothTime CVar has been changed to True, stop the stepped update timer and invalidate the timer handle.
-			if (useSmooth)
-			{
-				SmoothTime = true;
-				if (SteppedTimerHandle.IsValid())
-				{
-					GetWorldTimerManager().ClearTimer(SteppedTimerHandle);
-					SteppedTimerHandle.Invalidate();
-				}
-			}
-			//If SmoothTime CVar has been changed to False, start the timer for stepped update of the sun position.
-			if (!useSmooth)
+			if (VisualComponent)
 			{
-				SmoothTime = false;
-				FTimerDelegate TimerDelegate = FTimerDelegate::CreateUObject(this, &ADayNightController::UpdateSunPositionTimer);
-				GetWorldTimerManager().SetTimer(SteppedTimerHandle, TimerDelegate, SteppedTimeRate, true);
+				VisualComponent->DestroyComponent();
 			}
 		}
-	}	
-	
-	if ((EConsoleVariableFlags)((uint32)CVarStepRate.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting)
+		Sun = nullptr;
+		MoonLight = nullptr;
+		SkySphere = nullptr;
+		StarField = nullptr;
+		Atmosphere = nullptr;
+		SkyLight = nullptr;
+
+		if (SkySphereLoadHandle.IsValid())
+		{
+			SkySphereLoadHandle->CancelHandle();
+			SkySphereLoadHandle.Reset();
+		}
+	}
+
+	//Curve assets may have been edited since the level was loaded.
+	BakeSkyCurves();
+	UpdateSkyBodyParameterNames();
+
+	LoadStarCatalog();
+
+	//Levels are saved without the SkySphere's mesh and material, and OnConstruction doesn't run for actors loaded in a cooked game.
+	RequestSkySphereLoad();
+
+	if (SkyLight)
 	{
-		SteppedTimeRate = CVarStepRate.GetValueOnAnyThread();
-	}	
+		SkyLightScheduler.SetResolution(FMath::Clamp(SkyLight->CubemapResolution, SkyLightMinResolution, FMath::Max(SkyLightMaxResolution, SkyLightMinResolution)));
+	}
 
-	if ((EConsoleVariableFlags)((uint32)CVarDayLength.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting)
+	if (USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
 	{
-		LengthOfDay = CVarDayLength.GetValueOnAnyThread();
+		if (DayNight->HasHadPresenter())
+		{
+			//The clock is already running (this controller was streamed back in, or there's more than one). Take on its state rather than resetting it.
+			const FSimpleDayNightEphemerisParams& Params = DayNight->GetEphemerisParams();
+			Latitude = Params.Latitude;
+			AxialTilt = Params.AxialTilt;
+			SeasonLength = Params.SeasonLength;
+			LengthOfDay = DayNight->GetLengthOfDay();
+			ClockTickInterval = DayNight->GetTickInterval();
+
+			Clock = DayNight->GetTime();
+			TimeOfDay = ClockTimeOfDay = Clock.ToHours();
+		}
+		else
+		{
+			SyncClock();
+			DayNight->SetTime(Clock);
+			DayNight->SetEphemerisParams(GetEphemerisParams());
+			DayNight->SetLengthOfDay(LengthOfDay);
+			DayNight->SetTickInterval(ClockTickInterval);
+		}
+
+		PushedParams = GetEphemerisParams();
+		PushedLengthOfDay = LengthOfDay;
+		PushedClockTickInterval = ClockTickInterval;
+
+		DayNight->RegisterPresenter(this);
+
+		//OnCelestialEvent fires for every event type with no offset.
+		for (ECelestialEvent Event : TEnumRange<ECelestialEvent>())
+		{
+			CelestialEventHandles.Add(DayNight->GetEventScheduler().Register(Event, 0.0, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateUObject(this, &ADayNightController::BroadcastCelestialEvent)));
+		}
+
+		WarpHandle = DayNight->OnWarp.AddUObject(this, &ADayNightController::OnClockWarp);
+		ClockChangedHandle = DayNight->OnClockChanged.AddUObject(this, &ADayNightController::WakeTick);
 	}
 
-	if ((EConsoleVariableFlags)((uint32)CVarSeasonLength.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting)
+	//Update CVars to match locally overridden values.
+	//For some reason in a build this will throw an exception and crash if done in PostInitProperties()
+	CVarSmoothTime.AsVariable()->Set(SmoothTime, ECVF_SetByProjectSetting);
+	CVarSeasonLength.AsVariable()->Set(SeasonLength, ECVF_SetByProjectSetting);
+	CVarDayLength.AsVariable()->Set(LengthOfDay, ECVF_SetByProjectSetting);
+	CVarStepRate.AsVariable()->Set(SteppedTimeRate, ECVF_SetByProjectSetting);
+	CVarThresholdUpdate.AsVariable()->Set(ThresholdUpdate, ECVF_SetByProjectSetting);
+	CVarAngleThreshold.AsVariable()->Set(SunAngleThreshold, ECVF_SetByProjectSetting);
+	CVarCommitScheduler.AsVariable()->Set(CommitScheduler, ECVF_SetByProjectSetting);
+	CVarMaxDeferFrames.AsVariable()->Set(MaxDeferFrames, ECVF_SetByProjectSetting);
+	CVarMaxLagAngle.AsVariable()->Set(MaxLagAngle, ECVF_SetByProjectSetting);
+	CVarCacheKeysPerDay.AsVariable()->Set(OrientationCacheKeys, ECVF_SetByProjectSetting);
+	CVarTickInterval.AsVariable()->Set(ClockTickInterval, ECVF_SetByProjectSetting);
+	CVarSkyLightBudget.AsVariable()->Set(SkyLightBudget, ECVF_SetByProjectSetting);
+	CVarStarMagnitudeLimit.AsVariable()->Set(StarMagnitudeLimit, ECVF_SetByProjectSetting);
+	CVarTickPixels.AsVariable()->Set(TickPixelThreshold, ECVF_SetByProjectSetting);
+
+	//Only the sdn.* CVars are listened to, so changes to anything else cost nothing.
+	for (const TPair<IConsoleVariable*, FName>& LinkedCVar : GetLinkedCVars())
 	{
-		SeasonLength = CVarSeasonLength.GetValueOnAnyThread();
+		LinkedCVarHandles.Add(LinkedCVar.Key->OnChangedDelegate().AddUObject(this, &ADayNightController::OnLinkedCVarChanged, LinkedCVar.Value));
 	}
 
-	//If we're running editor save changes to DefaultSimpleDayNight.ini
-#if WITH_EDITOR
-	SaveConfig(CPF_Config, *GetDefaultConfigFilename());
-#else
-	//If we're running a build, save any changes that aren't from ProjectSetting to a local SimpleDayNight.ini
-	if ((EConsoleVariableFlags)((uint32)CVarSeasonLength.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting ||
-		(EConsoleVariableFlags)((uint32)CVarDayLength.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting ||
-		(EConsoleVariableFlags)((uint32)CVarStepRate.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting ||
-		(EConsoleVariableFlags)((uint32)CVarSmoothTime.AsVariable()->GetFlags() & ECVF_SetByMask) != ECVF_SetByProjectSetting)
+	RefreshSteppedTimer();
+}
+
+void ADayNightController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//The subsystem keeps the time while the controller is streamed out.
+	if (USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
 	{
-		SaveConfig();
+		for (const FDelegateHandle& Handle : CelestialEventHandles)
+		{
+			DayNight->GetEventScheduler().Unregister(Handle);
+		}
+		DayNight->OnWarp.Remove(WarpHandle);
+		DayNight->OnClockChanged.Remove(ClockChangedHandle);
+		DayNight->UnregisterPresenter(this);
 	}
-#endif
+	CelestialEventHandles.Reset();
+	WarpHandle.Reset();
+	ClockChangedHandle.Reset();
+
+	if (SkySphereLoadHandle.IsValid())
+	{
+		SkySphereLoadHandle->CancelHandle();
+		SkySphereLoadHandle.Reset();
+	}
+
+	const TArray<TPair<IConsoleVariable*, FName>>& LinkedCVars = GetLinkedCVars();
+	for (int32 Index = 0; Index < LinkedCVarHandles.Num(); ++Index)
+	{
+		LinkedCVars[Index].Key->OnChangedDelegate().Remove(LinkedCVarHandles[Index]);
+	}
+	LinkedCVarHandles.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
+// Called every frame
+void ADayNightController::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_ControllerTick);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADayNightController::Tick);
+	CSV_SCOPED_TIMING_STAT(SimpleDayNight, ControllerTick);
+
+	Super::Tick(DeltaTime);	
+
+	//Every frame skipped since the last tick is one saved.
+	ControllerTicks++;
+	if (LastTickFrame != 0 && GFrameCounter > LastTickFrame + 1)
+	{
+		TicksSaved += (int64)(GFrameCounter - LastTickFrame - 1);
+		CSV_CUSTOM_STAT(SimpleDayNight, TicksSaved, (int32)(GFrameCounter - LastTickFrame - 1), ECsvCustomStatOp::Accumulate);
+	}
+	LastTickFrame = GFrameCounter;
+
+	//DeltaTime covers every frame since the last tick, the scheduler wants the one that just finished.
+	SunCommitScheduler.AddFrameTime(FApp::GetDeltaTime());
+	UpdateCommitRate();
+
+	USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem();
+	if (DayNight)
+	{
+		//Only the primary controller's settings drive the clock. Any others just present it.
+		if (DayNight->IsPrimaryPresenter(this))
+		{
+			SyncClock();
+			PushSettings(*DayNight);
+		}
+
+		//Actors tick before tickable objects, so make sure the clock is up to date for this frame before drawing it.
+		DayNight->Advance();
+		UpdateClockReplication(*DayNight);
+		Clock = DayNight->GetTime();
+	}
+	else
+	{
+		SyncClock();
+		Clock.AddHours(DeltaTime * (24.0 / LengthOfDay / 60.0));
+	}
+	TimeOfDay = ClockTimeOfDay = Clock.ToHours();
+
+	UpdateTickInterval(DayNight);
+
+	//Headless controllers only keep time. Sun direction queries are answered from the clock.
+	if (bHeadless)
+	{
+		return;
+	}
+
+	UpdateViewLocation(DayNight);
+	UpdateStarField();
+
+	//Spread building tomorrow's orientation keys over today's frames.
+	if (OrientationCacheKeys > 0)
+	{
+		OrientationCache.Prefetch(2);
+	}
 
+	//A timed warp sweeps the sky far faster than normal, so the sun and stars only move together at WarpCommitRate instead of every frame.
+	if (DayNight && DayNight->IsWarping())
+	{
+		const double Now = GetWorld()->GetTimeSeconds();
+		if (WarpCommitRate > 0.0f && Now - LastWarpCommitTime >= 1.0 / WarpCommitRate)
+		{
+			LastWarpCommitTime = Now;
+			UpdateStarPosition();
+			UpdateSunPosition();
+		}
+		UpdateSkyLight();
+		return;
+	}
+
+	//Always update star position. Stars don't cast shadows, and the material StarRotationModes keep this off the SkySphere's transform.
+	UpdateStarPosition();
+
+	//Threshold update recomputes the sun direction every tick but only commits it once it has moved far enough.
+	//Otherwise only update Sun position on tick if SmoothTime is enabled.
+	if (ThresholdUpdate)
+	{
+		UpdateSunPositionThreshold();
+	}
+	else if (SmoothTime)
+	{
+		UpdateSunPosition();
+	}
+
+	//Stepped and threshold updates that have come due are committed on a frame with headroom, unless the sun has fallen too far behind.
+	if (SunCommitScheduler.IsCommitPending())
+	{
+		const double LagAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(GetSunDirection() | LastCommittedSunDirection, -1.0, 1.0)));
+
+		if (!CommitScheduler || SunCommitScheduler.ShouldCommit(MaxDeferFrames, LagAngle >= MaxLagAngle))
+		{
+			UpdateSunPosition();
+		}
+	}
+
+	UpdateSkyLight();
+}
+
+void ADayNightController::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	
+
+}
+
+void ADayNightController::UpdateSunPosition()
+{
+	if (!Sun)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_UpdateSunPosition);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADayNightController::UpdateSunPosition);
+
+	const FSimpleDayNightOrientation Orientation = GetOrientation();
+	const FQuat PreviousSunRotation = Sun->GetComponentQuat();
+
+	Axis->SetWorldRotation(Orientation.Axis);
+
+	//Wobble the Sun to fake seasons. Clock starts at Northern Winter Solstice.
+	Sun->SetRelativeRotation(Orientation.SunRelative);
+
+	//Any change to the light's rotation throws away every cached VSM page.
+	if (!Sun->GetComponentQuat().Equals(PreviousSunRotation, 0.0))
+	{
+		INC_DWORD_STAT(STAT_SimpleDayNight_TransformChanges);
+		CSV_CUSTOM_STAT(SimpleDayNight, TransformChanges, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	const FVector SunDirection = GetSunDirection();
+	if (!LastCommittedSunDirection.IsZero())
+	{
+		LastSunStepDegrees = (float)FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(SunDirection | LastCommittedSunDirection, -1.0, 1.0)));
+	}
+
+	LastCommittedSunDirection = SunDirection;
+	SunCommits++;
+	SunCommitScheduler.NotifyCommitted();
+
+	//Light and atmosphere follow the committed sun, not the one still to be drawn.
+	ApplySkyCurves();
+
+	//The moon and planets move with the sun's commits, so they never cost a shadow invalidation on a frame of their own.
+	UpdateSkyBodies();
+
+	//The sky the SkyLight sees only changes when the sun is committed.
+	if (IsSkyLightManaged())
+	{
+		FLinearColor SunColor = Sun->GetLightColor();
+		if (Atmosphere)
+		{
+			SunColor *= Atmosphere->GetAtmosphereTransmitanceOnGroundAtPlanetTop(Sun);
+		}
+		SkyLightScheduler.NotifySunCommitted(SunCommitScheduler.GetFrameNumber(), GetSunElevation(), SunColor, SkyLightElevationThreshold, SkyLightColorThreshold);
+	}
+
+	INC_DWORD_STAT(STAT_SimpleDayNight_SunCommits);
+	CSV_CUSTOM_STAT(SimpleDayNight, SunCommits, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void ADayNightController::UpdateCommitRate()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (CommitRateWindowStart == 0.0)
+	{
+		CommitRateWindowStart = Now;
+		CommitRateWindowCommits = SunCommits;
+		CommitRateWindowTicks = ControllerTicks;
+	}
+	else if (Now - CommitRateWindowStart >= 1.0)
+	{
+		SunCommitsPerSecond = (float)((SunCommits - CommitRateWindowCommits) / (Now - CommitRateWindowStart));
+		TicksPerSecond = (float)((ControllerTicks - CommitRateWindowTicks) / (Now - CommitRateWindowStart));
+		CommitRateWindowStart = Now;
+		CommitRateWindowCommits = SunCommits;
+		CommitRateWindowTicks = ControllerTicks;
+	}
+
+	SET_FLOAT_STAT(STAT_SimpleDayNight_SunCommitsPerSecond, SunCommitsPerSecond);
+	SET_FLOAT_STAT(STAT_SimpleDayNight_SunStep, LastSunStepDegrees);
+	SET_FLOAT_STAT(STAT_SimpleDayNight_TicksPerSecond, TicksPerSecond);
+	CSV_CUSTOM_STAT(SimpleDayNight, SunCommitsPerSecond, SunCommitsPerSecond, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(SimpleDayNight, SunStepDegrees, LastSunStepDegrees, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(SimpleDayNight, ControllerTicksPerSecond, TicksPerSecond, ECsvCustomStatOp::Set);
+}
+
+void ADayNightController::UpdateTickInterval(const USimpleDayNightSubsystem* DayNight)
+{
+	const double HoursPerSecond = DayNight ? DayNight->GetCurrentHoursPerSecond() : (LengthOfDay > 0.0f ? 24.0 / LengthOfDay / 60.0 : 0.0);
+	const bool bWarping = DayNight && DayNight->IsWarping();
+
+	//Warps, held back sun commits and SkyLight recaptures look for their frame on every frame, and a view culled star field follows the camera.
+	const bool bPending = bWarping || SunCommitScheduler.IsCommitPending() || (IsSkyLightManaged() && SkyLightScheduler.IsBusy());
+
+	//The sky still follows the camera with the clock stopped: a view culled star field every frame, the latitude regions now and then.
+	const bool bFollowStars = StarViewCulling && bStarFieldBuilt;
+	const bool bFollowRegions = DayNight && DayNight->GetNumRegions() > 0;
+
+	//Otherwise nothing moves while the clock is stopped, so there's nothing to tick for until something starts it again (see WakeTick).
+	//Clients keep going until they've caught up with the server.
+	if (HoursPerSecond == 0.0 && !bPending && !bFollowStars && !bFollowRegions && FMath::IsNearlyZero(ClockErrorHours, 1e-6))
+	{
+		SetActorTickEnabled(false);
+		TicksPerSecond = 0.0f;
+		SET_FLOAT_STAT(STAT_SimpleDayNight_TicksPerSecond, 0.0f);
+		return;
+	}
+
+	float Interval = 0.0f;
+	if (TickPixelThreshold > 0.0f && !bPending && !bFollowStars)
+	{
+		//Nobody's looking on a server, so only replication and events need the tick.
+		Interval = MaxTickInterval;
+
+		const APlayerController* PlayerController = GEngine && !bHeadless ? GEngine->GetFirstLocalPlayerController(GetWorld()) : nullptr;
+		int32 ViewportWidth = 0;
+		int32 ViewportHeight = 0;
+		if (PlayerController && PlayerController->PlayerCameraManager)
+		{
+			PlayerController->GetViewportSize(ViewportWidth, ViewportHeight);
+		}
+
+		const double RadiansPerSecond = FMath::Abs(HoursPerSecond) / 24.0 * 2.0 * PI;
+		if (ViewportWidth > 0 && RadiansPerSecond > 0.0)
+		{
+			//The sky turns once a day, and a radian in the middle of the screen is half the width over the tangent of half the FOV.
+			const float FOV = FMath::Clamp(PlayerController->PlayerCameraManager->GetCameraCacheView().FOV, 1.0f, 170.0f);
+			const double PixelsPerRadian = ViewportWidth * 0.5 / FMath::Tan(FMath::DegreesToRadians(FOV * 0.5));
+			Interval = FMath::Min(Interval, (float)(TickPixelThreshold / (RadiansPerSecond * PixelsPerRadian)));
+		}
+	}
+
+	if (PrimaryActorTick.TickInterval != Interval)
+	{
+		SetActorTickInterval(Interval);
+	}
+}
+
+void ADayNightController::WakeTick()
+{
+	const UWorld* World = GetWorld();
+	if (!World || !World->IsGameWorld() || !PrimaryActorTick.bCanEverTick)
+	{
+		return;
+	}
+
+	//The next tick works the interval out again for whatever changed.
+	SetActorTickInterval(0.0f);
+	SetActorTickEnabled(true);
+}
+
+void ADayNightController::SetTimeOfDay(double InTimeOfDay)
+{
+	//Picked up by SyncClock on the next tick.
+	TimeOfDay = InTimeOfDay;
+	WakeTick();
+}
+
+FVector ADayNightController::GetSunDirection() const
+{
+	if (bHasViewLocation)
+	{
+		if (const USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
+		{
+			return DayNight->EvaluateSunDirectionAt(ViewLocation, Clock);
+		}
+	}
+
+	return FSimpleDayNightEphemeris::GetSunDirection(Clock, GetEphemerisParams());
+}
+
+double ADayNightController::GetSunElevation() const
+{
+	if (bHasViewLocation)
+	{
+		return FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-GetSunDirection().Z, -1.0, 1.0)));
+	}
+
+	return FSimpleDayNightEphemeris::GetSunElevation(Clock, GetEphemerisParams());
+}
+
+void ADayNightController::UpdateSkyBodies()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_UpdateSkyBodies);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADayNightController::UpdateSkyBodies);
+
+	SkyBodyBatch.Reset();
+	SkyBodyBatch.Add(MoonBody.GetOrbit());
+	for (const FSimpleDayNightSkyBody& Body : SkyBodies)
+	{
+		SkyBodyBatch.Add(Body.GetOrbit());
+	}
+
+	FSimpleDayNightEphemerisParams Params = GetEphemerisParams();
+	Params.Latitude = GetViewLatitude();
+	FSimpleDayNightEphemeris::EvaluateBodies(SkyBodyBatch, Clock, Params);
+
+	if (MoonLight)
+	{
+		//The moon only moves once it's gone as far as the sun has to, so a shadow casting MoonLight doesn't throw its pages away on every sun commit.
+		const FVector MoonDirection = GetMoonDirection();
+		if (LastMoonLightDirection.IsZero() || (MoonDirection | LastMoonLightDirection) <= FMath::Cos(FMath::DegreesToRadians((double)SunAngleThreshold)))
+		{
+			MoonLight->SetWorldRotation(MoonDirection.Rotation());
+			LastMoonLightDirection = MoonDirection;
+		}
+
+		//Fade out as the moon sets rather than lighting the level from below the horizon.
+		const float Intensity = MoonIntensity * SkyBodyBatch.Illumination[0] * FMath::SmoothStep(-2.0f, 2.0f, SkyBodyBatch.Elevation[0]);
+		if (FMath::Abs(Intensity - MoonLight->Intensity) > CurveTolerance * FMath::Max(FMath::Abs(MoonLight->Intensity), 1.0f))
+		{
+			MoonLight->SetIntensity(Intensity);
+		}
+	}
+
+	if (SkyBodyCollection && GetWorld())
+	{
+		if (UMaterialParameterCollectionInstance* CollectionInstance = GetWorld()->GetParameterCollectionInstance(SkyBodyCollection))
+		{
+			//Blueprint can rename or add bodies at any time, but checking for it is only a compare of names.
+			UpdateSkyBodyParameterNames();
+
+			for (int32 Index = 0; Index < SkyBodyBatch.Num(); ++Index)
+			{
+				const FVector ToBody = -GetSkyBodyDirection(Index);
+
+				CollectionInstance->SetVectorParameterValue(SkyBodyParameterNames[Index].Direction, FLinearColor(ToBody.X, ToBody.Y, ToBody.Z, SkyBodyBatch.Illumination[Index]));
+				CollectionInstance->SetScalarParameterValue(SkyBodyParameterNames[Index].Phase, SkyBodyBatch.Phase[Index]);
+			}
+		}
+	}
+}
+
+void ADayNightController::UpdateSkyBodyParameterNames()
+{
+	SkyBodyParameterNames.SetNum(SkyBodies.Num() + 1);
+	for (int32 Index = 0; Index < SkyBodyParameterNames.Num(); ++Index)
+	{
+		const FName Name = Index == 0 ? MoonBody.Name : SkyBodies[Index - 1].Name;
+		FSkyBodyParameterNames& Names = SkyBodyParameterNames[Index];
+		if (Names.Body != Name || Names.Direction.IsNone())
+		{
+			Names.Body = Name;
+			Names.Direction = FName(*(Name.ToString() + TEXT("Direction")));
+			Names.Phase = FName(*(Name.ToString() + TEXT("Phase")));
+		}
+	}
+}
+
+FVector ADayNightController::GetSkyBodyDirection(int32 Index) const
+{
+	if (!SkyBodyBatch.DirectionX.IsValidIndex(Index))
+	{
+		return FVector::ZeroVector;
+	}
+
+	return FVector(SkyBodyBatch.DirectionX[Index], SkyBodyBatch.DirectionY[Index], SkyBodyBatch.DirectionZ[Index]);
+}
+
+float ADayNightController::GetViewLatitude() const
+{
+	if (bHasViewLocation)
+	{
+		if (const USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
+		{
+			return DayNight->GetLatitudeAt(ViewLocation);
+		}
+	}
+
+	return Latitude;
+}
+
+void ADayNightController::UpdateViewLocation(const USimpleDayNightSubsystem* DayNight)
+{
+	bHasViewLocation = false;
+	if (!DayNight || DayNight->GetNumRegions() == 0)
+	{
+		return;
+	}
+
+	//There's only one sun to draw, so split-screen players all see the sky from the first local player.
+	//Anything that needs each player's own sun should ask the subsystem with GetSunDirectionAt.
+	const APlayerController* PlayerController = GEngine ? GEngine->GetFirstLocalPlayerController(GetWorld()) : nullptr;
+	if (PlayerController && PlayerController->PlayerCameraManager)
+	{
+		ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		bHasViewLocation = true;
+	}
+}
+
+bool ADayNightController::ShouldCreateVisualComponents()
+{
+#if WITH_EDITOR
+	//Cooking and the editor need the components so they're saved with levels and Blueprints.
+	if (GIsEditor)
+	{
+		return true;
+	}
+#endif
+
+	//Covers dedicated servers, -nullrhi and commandlets.
+	return FApp::CanEverRender() || FParse::Param(FCommandLine::Get(), TEXT("SimpleDayNightVisuals"));
+}
+
+FSimpleDayNightEphemerisParams ADayNightController::GetEphemerisParams() const
+{
+	FSimpleDayNightEphemerisParams Params;
+	Params.Latitude = Latitude;
+	Params.AxialTilt = AxialTilt;
+	Params.SeasonLength = SeasonLength;
+	return Params;
+}
+
+FSimpleDayNightOrientation ADayNightController::GetOrientation()
+{
+	FSimpleDayNightOrientation Orientation = OrientationCacheKeys > 0 && !bScrubbing ? OrientationCache.Sample(Clock, GetEphemerisParams()) : FSimpleDayNightEphemeris::Evaluate(Clock, GetEphemerisParams());
+
+	if (bHasViewLocation)
+	{
+		if (USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
+		{
+			DayNight->BlendRegionOrientation(ViewLocation, Clock, Orientation);
+		}
+	}
+
+	return Orientation;
+}
+
+void ADayNightController::InvalidateOrientationCache()
+{
+	OrientationCache.Invalidate();
+}
+
+USimpleDayNightSubsystem* ADayNightController::GetDayNightSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World ? World->GetSubsystem<USimpleDayNightSubsystem>() : nullptr;
+}
+
+void ADayNightController::SyncClock()
+{
+	if (TimeOfDay != ClockTimeOfDay)
+	{
+		Clock = FSimpleDayNightTime::FromHours(TimeOfDay);
+		ClockTimeOfDay = TimeOfDay;
+
+		//Other controllers get put back to the world's time on their next tick.
+		USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem();
+		if (DayNight && DayNight->IsPrimaryPresenter(this))
+		{
+			DayNight->SetTime(Clock);
+		}
+	}
+}
+
+void ADayNightController::PushSettings(USimpleDayNightSubsystem& DayNight)
+{
+	const FSimpleDayNightEphemerisParams Params = GetEphemerisParams();
+	if (Params != PushedParams)
+	{
+		DayNight.SetEphemerisParams(Params);
+		PushedParams = Params;
+	}
+
+	if (LengthOfDay != PushedLengthOfDay)
+	{
+		DayNight.SetLengthOfDay(LengthOfDay);
+		PushedLengthOfDay = LengthOfDay;
+	}
+
+	if (ClockTickInterval != PushedClockTickInterval)
+	{
+		DayNight.SetTickInterval(ClockTickInterval);
+		PushedClockTickInterval = ClockTickInterval;
+	}
+}
+
+double ADayNightController::GetServerTime() const
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return 0.0;
+	}
+
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+void ADayNightController::UpdateClockReplication(USimpleDayNightSubsystem& DayNight)
+{
+	const ENetMode NetMode = GetNetMode();
+	if (NetMode == NM_Standalone)
+	{
+		return;
+	}
+
+	const double ServerTime = GetServerTime();
+
+	if (HasAuthority())
+	{
+		//One controller is enough to carry the clock.
+		if (!DayNight.IsPrimaryPresenter(this))
+		{
+			return;
+		}
+
+		const bool bClockJumped = DayNight.GetClockGeneration() != ReplicatedClockGeneration;
+		const bool bHeartbeatDue = ServerTime - ReplicatedClock.EpochServerTime >= ClockHeartbeatInterval;
+		const bool bRateChanged = ReplicatedClock.LengthOfDay != DayNight.GetLengthOfDay() || ReplicatedClock.SeasonLength != DayNight.GetEphemerisParams().SeasonLength;
+
+		if (bClockJumped || bRateChanged || bHeartbeatDue || !ReplicatedClock.IsValid())
+		{
+			const FSimpleDayNightTime Time = DayNight.GetTime();
+			ReplicatedClock.EpochDay = Time.Day;
+			ReplicatedClock.EpochHour = Time.Hour;
+			ReplicatedClock.EpochServerTime = ServerTime;
+			ReplicatedClock.LengthOfDay = DayNight.GetLengthOfDay();
+			ReplicatedClock.SeasonLength = DayNight.GetEphemerisParams().SeasonLength;
+			ReplicatedClockGeneration = DayNight.GetClockGeneration();
+
+			//Warps bump the clock generation, so a new one goes out straight away. Clients play it back from the target and end time.
+			ReplicatedClock.WarpSerial = (uint8)DayNight.GetWarpCount();
+			if (DayNight.IsWarping())
+			{
+				const FSimpleDayNightTime& Target = DayNight.GetWarpTarget();
+				ReplicatedClock.WarpTargetDay = Target.Day;
+				ReplicatedClock.WarpTargetHour = Target.Hour;
+				ReplicatedClock.WarpEndServerTime = ServerTime + (DayNight.GetWarpEndWorldTime() - GetWorld()->GetTimeSeconds());
+				ReplicatedClock.bCollapseWarpEvents = DayNight.IsCollapsingWarpEvents();
+			}
+			else
+			{
+				ReplicatedClock.WarpEndServerTime = 0.0;
+			}
+
+			if (ClockUpdatesSent == 0)
+			{
+				ReplicationStartTime = ServerTime;
+			}
+			ClockUpdatesSent++;
+			ClockBytesSent += ReplicatedClock.GetSerializedSize();
+		}
+	}
+	else if (ReplicatedClock.IsValid() && !DayNight.IsWarping())
+	{
+		//Warps land exactly on the server's target, so there's nothing to correct until they do.
+		ClockErrorHours = ReplicatedClock.Extrapolate(ServerTime).HoursSince(DayNight.GetTime());
+
+		//Slew the local clock towards the server's once per update instead of snapping, so the sun keeps moving smoothly and doesn't cause extra VSM rebuilds.
+		//In between the error is only measured, it closes on its own as the slew runs.
+		if (ReplicatedClock.EpochServerTime != CorrectedEpochServerTime)
+		{
+			CorrectedEpochServerTime = ReplicatedClock.EpochServerTime;
+			DayNight.CorrectClock(ClockErrorHours, FSimpleDayNightReplicatedClock::GetCorrectionTime(ClockErrorHours, ClockCorrectionTime, ClockSnapHours));
+		}
+	}
+}
+
+void ADayNightController::OnRep_ReplicatedClock()
+{
+	//The rate is the server's to decide.
+	LengthOfDay = ReplicatedClock.LengthOfDay;
+	SeasonLength = ReplicatedClock.SeasonLength;
+
+	//Straight to the subsystem, in case this isn't the client's primary controller.
+	if (USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
+	{
+		FSimpleDayNightEphemerisParams Params = DayNight->GetEphemerisParams();
+		Params.SeasonLength = SeasonLength;
+		DayNight->SetEphemerisParams(Params);
+		DayNight->SetLengthOfDay(LengthOfDay);
+
+		//Play the server's warps locally, so events fire and the sun is committed the same way as on the server.
+		const double ServerTime = GetServerTime();
+		const bool bWarpRunning = ReplicatedClock.IsWarping() && ServerTime < ReplicatedClock.WarpEndServerTime;
+		if (!bReceivedClock)
+		{
+			//Joining in the middle of a game isn't a warp, just start from the server's time and catch the rest of any warp that's running.
+			bReceivedClock = true;
+			ReplicatedWarpSerial = ReplicatedClock.WarpSerial;
+			DayNight->SetTime(ReplicatedClock.Extrapolate(ServerTime));
+
+			if (bWarpRunning)
+			{
+				DayNight->WarpTo(ReplicatedClock.GetWarpTarget(), (float)(ReplicatedClock.WarpEndServerTime - ServerTime), ReplicatedClock.bCollapseWarpEvents);
+			}
+		}
+		else if (ReplicatedClock.WarpSerial != ReplicatedWarpSerial)
+		{
+			ReplicatedWarpSerial = ReplicatedClock.WarpSerial;
+
+			if (bWarpRunning)
+			{
+				DayNight->WarpTo(ReplicatedClock.GetWarpTarget(), (float)(ReplicatedClock.WarpEndServerTime - ServerTime), ReplicatedClock.bCollapseWarpEvents);
+			}
+			else
+			{
+				DayNight->WarpTo(ReplicatedClock.Extrapolate(ServerTime), 0.0f, ReplicatedClock.bCollapseWarpEvents);
+			}
+		}
+		else if (!ReplicatedClock.IsWarping() && DayNight->IsWarping())
+		{
+			//The server cut its warp short.
+			DayNight->SetTime(ReplicatedClock.Extrapolate(ServerTime));
+		}
+	}
+
+	//The new epoch is corrected towards on the next tick, even if the clock was stopped.
+	WakeTick();
+}
+
+void ADayNightController::OnClockWarp(bool bFinished)
+{
+	WakeTick();
+
+	if (!bFinished)
+	{
+		//The first commit on the way waits a full interval.
+		LastWarpCommitTime = GetWorld()->GetTimeSeconds();
+		return;
+	}
+
+	Clock = GetDayNightSubsystem()->GetTime();
+	TimeOfDay = ClockTimeOfDay = Clock.ToHours();
+
+	if (bHeadless)
+	{
+		return;
+	}
+
+	//One commit for the whole warp. Anything the commit scheduler was holding back is covered by it too.
+	UpdateStarPosition();
+	UpdateSunPosition();
+}
+
+void ADayNightController::BroadcastCelestialEvent(ECelestialEvent Event, double OffsetHours)
+{
+	OnCelestialEvent.Broadcast(Event, (float)OffsetHours);
+}
+
+void ADayNightController::BindCelestialEvent(ECelestialEvent Event, float OffsetHours, FCelestialEventDelegate Delegate)
+{
+	//The events belong to the world's clock, so bindings outlive the controller being streamed out.
+	if (USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
+	{
+		DayNight->BindCelestialEvent(Event, OffsetHours, Delegate);
+	}
+}
+
+void ADayNightController::UnbindCelestialEvent(FCelestialEventDelegate Delegate)
+{
+	if (USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem())
+	{
+		DayNight->UnbindCelestialEvent(Delegate);
+	}
+}
+
+double ADayNightController::GetHoursUntilCelestialEvent(ECelestialEvent Event) const
+{
+	FSimpleDayNightTime EventTime;
+	if (FSimpleDayNightEventScheduler::FindNextEvent(Event, Clock, GetEphemerisParams(), EventTime))
+	{
+		return EventTime.HoursSince(Clock);
+	}
+	return -1.0;
+}
+
+float ADayNightController::GetClockBytesPerMinute() const
+{
+	const double Minutes = (GetServerTime() - ReplicationStartTime) / 60.0;
+	return Minutes > 0.0 ? (float)(ClockBytesSent / Minutes) : 0.0f;
+}
+
+void ADayNightController::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ADayNightController, ReplicatedClock);
+}
+
+void ADayNightController::BakeSkyCurves()
+{
+	SkyCurveTable.Bake(SkyCurves);
+	bCurvesPushed = false;
+
+	if (Sun && SkyCurveTable.HasChannel(FSimpleDayNightCurveTable::SunTemperature))
+	{
+		Sun->SetUseTemperature(true);
+	}
+}
+
+void ADayNightController::ApplySkyCurves()
+{
+	if (SkyCurveTable.IsEmpty())
+	{
+		return;
+	}
+
+	//The season curve runs from the local winter solstice, which is half a year round in the Southern Hemisphere.
+	double SeasonPhase = FSimpleDayNightEphemeris::GetSeasonPhase(Clock, SeasonLength);
+	if (GetViewLatitude() < 0.0f)
+	{
+		SeasonPhase += 0.5;
+	}
+
+	float Values[FSimpleDayNightCurveTable::NumChannels];
+	FMemory::Memcpy(Values, PushedCurveValues, sizeof(Values));
+	SkyCurveTable.Sample(GetSunElevation(), SeasonPhase, Values);
+
+	//Setting any of these dirties the component's render state, so only do it when the change would be seen.
+	auto Changed = [this, &Values](int32 First, int32 Count)
+	{
+		if (!SkyCurveTable.HasChannel((FSimpleDayNightCurveTable::EChannel)First))
+		{
+			return false;
+		}
+		for (int32 Channel = First; Channel < First + Count; ++Channel)
+		{
+			if (!bCurvesPushed || FMath::Abs(Values[Channel] - PushedCurveValues[Channel]) > CurveTolerance * FMath::Max(FMath::Abs(PushedCurveValues[Channel]), 1.0f))
+			{
+				for (int32 Pushed = First; Pushed < First + Count; ++Pushed)
+				{
+					PushedCurveValues[Pushed] = Values[Pushed];
+				}
+				CurvePushes++;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	if (Sun)
+	{
+		if (Changed(FSimpleDayNightCurveTable::SunIntensity, 1))
+		{
+			Sun->SetIntensity(Values[FSimpleDayNightCurveTable::SunIntensity]);
+		}
+		if (Changed(FSimpleDayNightCurveTable::SunTemperature, 1))
+		{
+			Sun->SetTemperature(Values[FSimpleDayNightCurveTable::SunTemperature]);
+		}
+		if (Changed(FSimpleDayNightCurveTable::SunColorR, 3))
+		{
+			Sun->SetLightColor(FLinearColor(Values[FSimpleDayNightCurveTable::SunColorR], Values[FSimpleDayNightCurveTable::SunColorG], Values[FSimpleDayNightCurveTable::SunColorB]));
+		}
+	}
+
+	if (Atmosphere)
+	{
+		if (Changed(FSimpleDayNightCurveTable::RayleighScatteringScale, 1))
+		{
+			Atmosphere->SetRayleighScatteringScale(Values[FSimpleDayNightCurveTable::RayleighScatteringScale]);
+		}
+		if (Changed(FSimpleDayNightCurveTable::MieScatteringScale, 1))
+		{
+			Atmosphere->SetMieScatteringScale(Values[FSimpleDayNightCurveTable::MieScatteringScale]);
+		}
+		if (Changed(FSimpleDayNightCurveTable::SkyLuminanceR, 3))
+		{
+			Atmosphere->SetSkyLuminanceFactor(FLinearColor(Values[FSimpleDayNightCurveTable::SkyLuminanceR], Values[FSimpleDayNightCurveTable::SkyLuminanceG], Values[FSimpleDayNightCurveTable::SkyLuminanceB]));
+		}
+	}
+
+	bCurvesPushed = true;
+}
+
+bool ADayNightController::IsSkyLightManaged() const
+{
+	return ManageSkyLight && SkyLight && !bHeadless;
+}
+
+void ADayNightController::UpdateSkyLight()
+{
+	if (!IsSkyLightManaged())
+	{
+		return;
+	}
+
+	SkyLightScheduler.Update(SunCommitScheduler, SkyLightBudget, SkyLightMinResolution, FMath::Max(SkyLightMaxResolution, SkyLightMinResolution));
+	LastSkyLightCaptureCostMs = SkyLightScheduler.GetLastCaptureCostMs();
+
+	if (SkyLightScheduler.ShouldRecapture(SunCommitScheduler, SkyLightMaxDeferFrames))
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_SkyLightRecapture);
+		TRACE_CPUPROFILER_EVENT_SCOPE(ADayNightController::UpdateSkyLight);
+
+		//The capture itself renders at the end of this frame, its cost is measured from the next frame's time.
+		SkyLight->CubemapResolution = SkyLightScheduler.GetResolution();
+		SkyLight->RecaptureSky();
+
+		SkyLightScheduler.NotifyRecaptured(SunCommitScheduler.GetFrameNumber());
+		SkyLightRecaptures++;
+
+		INC_DWORD_STAT(STAT_SimpleDayNight_SkyLightRecaptures);
+		CSV_CUSTOM_STAT(SimpleDayNight, SkyLightRecaptures, 1, ECsvCustomStatOp::Accumulate);
+	}
+}
+
+void ADayNightController::UpdateSunPositionThreshold()
+{
+	const double CosThreshold = FMath::Cos(FMath::DegreesToRadians((double)SunAngleThreshold));
+
+	//Directions are unit length, so the dot product is the cosine of the angle the sun has moved since the last commit.
+	if ((GetSunDirection() | LastCommittedSunDirection) <= CosThreshold)
+	{
+		if (CommitScheduler)
+		{
+			SunCommitScheduler.RequestCommit();
+		}
+		else
+		{
+			UpdateSunPosition();
+		}
+	}
+	else
+	{
+		SkippedSunCommits++;
+
+		INC_DWORD_STAT(STAT_SimpleDayNight_SkippedSunCommits);
+		CSV_CUSTOM_STAT(SimpleDayNight, SkippedSunCommits, 1, ECsvCustomStatOp::Accumulate);
+	}
+}
+
+void ADayNightController::UpdateStarPosition()
+{
+	if (!SkySphere)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_UpdateStarPosition);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADayNightController::UpdateStarPosition);
+
+	//Fake seasonal procession of the stars by offsetting the hour angle with the position in the year.
+	const FQuat StarRotation = GetOrientation().Stars;
+
+	if (StarField && StarField->IsVisible())
+	{
+		StarField->SetWorldRotation(StarRotation);
+	}
+
+	bool bSentToMaterial = false;
+
+	switch (StarRotationMode)
+	{
+	case EStarRotationMode::MaterialParameterCollection:
+		if (StarRotationCollection && GetWorld())
+		{
+			if (UMaterialParameterCollectionInstance* CollectionInstance = GetWorld()->GetParameterCollectionInstance(StarRotationCollection))
+			{
+				bSentToMaterial = CollectionInstance->SetVectorParameterValue(StarRotationParameter, FLinearColor(StarRotation.X, StarRotation.Y, StarRotation.Z, StarRotation.W));
+			}
+		}
+		break;
+
+	case EStarRotationMode::CustomPrimitiveData:
+		SkySphere->SetCustomPrimitiveDataVector4(StarRotationDataIndex, FVector4(StarRotation.X, StarRotation.Y, StarRotation.Z, StarRotation.W));
+		bSentToMaterial = true;
+		break;
+
+	default:
+		break;
+	}
+
+	if (bSentToMaterial)
+	{
+		//The material does the rotating, so the sphere itself has to stay unrotated. This only moves it once after switching modes.
+		if (!SkySphere->GetComponentQuat().Equals(FQuat::Identity))
+		{
+			SkySphere->SetWorldRotation(FQuat::Identity);
+		}
+		StarTransformUpdatesAvoided++;
+	}
+	else
+	{
+		SkySphere->SetWorldRotation(StarRotation);
+
+		//Only counts against VSM if the sphere casts a shadow, which it shouldn't.
+		if (SkySphere->CastShadow)
+		{
+			INC_DWORD_STAT(STAT_SimpleDayNight_TransformChanges);
+			CSV_CUSTOM_STAT(SimpleDayNight, TransformChanges, 1, ECsvCustomStatOp::Accumulate);
+		}
+	}
+}
+
+void ADayNightController::UpdateSunPositionTimer()
+{
+	//Warps commit at their own rate.
+	const USimpleDayNightSubsystem* DayNight = GetDayNightSubsystem();
+	if (DayNight && DayNight->IsWarping())
+	{
+		return;
+	}
+
+	//Let the scheduler pick the frame, so the VSM rebuild doesn't land on whichever frame the timer fires on.
+	if (CommitScheduler)
+	{
+		SunCommitScheduler.RequestCommit();
+	}
+	else
+	{
+		UpdateSunPosition();
+	}
+}
+
+float ADayNightController::GetFrameTimePercentile(float Percentile) const
+{
+	return SunCommitScheduler.GetFrameTimePercentile(Percentile);
+}
+
+void ADayNightController::RefreshSteppedTimer()
+{
+	//The stepped update timer only runs when neither smooth nor threshold update is in use, and there's a sun to update.
+	const bool bUseTimer = !SmoothTime && !ThresholdUpdate && !bHeadless;
+
+	if (bUseTimer && !SteppedTimerHandle.IsValid())
+	{
+		FTimerDelegate TimerDelegate = FTimerDelegate::CreateUObject(this, &ADayNightController::UpdateSunPositionTimer);
+		GetWorldTimerManager().SetTimer(SteppedTimerHandle, TimerDelegate, SteppedTimeRate, true);
+	}
+	else if (!bUseTimer && SteppedTimerHandle.IsValid())
+	{
+		GetWorldTimerManager().ClearTimer(SteppedTimerHandle);
+		SteppedTimerHandle.Invalidate();
+	}
+}
+
+void ADayNightController::OnLinkedCVarChanged(IConsoleVariable* Variable, FName PropertyName)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_CVarChanged);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADayNightController::OnLinkedCVarChanged);
+
+	//Project Settings, the ini and BeginPlay set the CVars from the config, so there's nothing to apply or save.
+	if ((EConsoleVariableFlags)((uint32)Variable->GetFlags() & ECVF_SetByMask) == ECVF_SetByProjectSetting)
+	{
+		return;
+	}
+
+	FProperty* Property = FindFProperty<FProperty>(GetClass(), PropertyName);
+	bool bChanged = false;
+
+	if (FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		bChanged = BoolProperty->GetPropertyValue_InContainer(this) != Variable->GetBool();
+		BoolProperty->SetPropertyValue_InContainer(this, Variable->GetBool());
+	}
+	else if (FFloatProperty* FloatProperty = CastField<FFloatProperty>(Property))
+	{
+		bChanged = FloatProperty->GetPropertyValue_InContainer(this) != Variable->GetFloat();
+		FloatProperty->SetPropertyValue_InContainer(this, Variable->GetFloat());
+	}
+	else if (FIntProperty* IntProperty = CastField<FIntProperty>(Property))
+	{
+		bChanged = IntProperty->GetPropertyValue_InContainer(this) != Variable->GetInt();
+		IntProperty->SetPropertyValue_InContainer(this, Variable->GetInt());
+	}
+
+	if (!bChanged)
+	{
+		return;
+	}
+
+	//Start or stop the stepped update timer if the update mode changed, and work the tick interval out again for the new settings.
+	RefreshSteppedTimer();
+	OrientationCache.SetKeysPerDay(OrientationCacheKeys);
+	WakeTick();
+
+	//Scalability levels keep their own values in the scalability ini, they aren't project settings.
+	if ((EConsoleVariableFlags)((uint32)Variable->GetFlags() & ECVF_SetByMask) == ECVF_SetByScalability)
+	{
+		return;
+	}
+
+	QueueConfigSave(PropertyName);
+}
+
+void ADayNightController::QueueConfigSave(FName PropertyName)
+{
+	FProperty* Property = FindFProperty<FProperty>(GetClass(), PropertyName);
+	if (!Property)
+	{
+		return;
+	}
+
+	//Only the field that changed is saved. The write itself is coalesced with any other changes.
+	FString Value;
+	Property->ExportText_InContainer(0, Value, this, nullptr, this, PPF_None);
+
+	//Keep the in-memory config in step, so controllers spawned later load the new value.
+	const FString Section = GetClass()->GetPathName();
+	GConfig->SetString(*Section, *PropertyName.ToString(), *Value, GetClass()->GetConfigName());
+
+#if WITH_EDITOR
+	//DefaultSimpleDayNight.ini isn't one of GConfig's files, so the writer updates it on disk.
+	FSimpleDayNightConfigWriter::Get().SetValue(GetDefaultConfigFilename(), Section, PropertyName.ToString(), Value);
+#else
+	//The local SimpleDayNight.ini is, GConfig writes it out with the new value.
+	FSimpleDayNightConfigWriter::Get().QueueFlush(GetClass()->GetConfigName());
+#endif
+}
@@ -0,0 +1,393 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightBenchmarkCommandlet.h"
+#include "DayNightController.h"
+#include "SimpleDayNightEphemeris.h"
+#include "SimpleDayNightEventScheduler.h"
+#include "SimpleDayNightOrientationCache.h"
+#include "SimpleDayNightStarCatalog.h"
+#include "SimpleDayNightSubsystem.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+//Keeps the optimizer from throwing away the results being timed
+static double BenchmarkChecksum = 0.0;
+
+USimpleDayNightBenchmarkCommandlet::USimpleDayNightBenchmarkCommandlet()
+{
+	//Run like a game, so the controllers decide for themselves whether to create their components.
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USimpleDayNightBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("SimpleDayNight") / TEXT("Benchmark.json");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	int32 Days = 8;
+	FParse::Value(*Params, TEXT("Days="), Days);
+
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+	Results->SetStringField(TEXT("Platform"), FString(FPlatformProperties::IniPlatformName()));
+	Results->SetStringField(TEXT("Configuration"), LexToString(FApp::GetBuildConfiguration()));
+	Results->SetBoolField(TEXT("VisualComponents"), ADayNightController::ShouldCreateVisualComponents());
+
+	UE_LOG(LogTemp, Display, TEXT("SimpleDayNight benchmark: math"));
+	Results->SetObjectField(TEXT("Math"), RunMathBenchmarks());
+
+	UE_LOG(LogTemp, Display, TEXT("SimpleDayNight benchmark: star catalog"));
+	Results->SetObjectField(TEXT("StarCatalog"), RunStarCatalogBenchmark());
+
+	TArray<TSharedPtr<FJsonValue>> Controllers;
+	for (const int32 NumControllers : { 1, 10, 1000 })
+	{
+		UE_LOG(LogTemp, Display, TEXT("SimpleDayNight benchmark: %d controllers"), NumControllers);
+		Controllers.Add(MakeShared<FJsonValueObject>(RunControllerBenchmark(NumControllers)));
+	}
+	Results->SetArrayField(TEXT("Controllers"), Controllers);
+
+	TArray<TSharedPtr<FJsonValue>> Simulations;
+	for (const FVector2f& Setting : { FVector2f(1.0f, 1.0f), FVector2f(10.0f, 4.0f), FVector2f(24.0f, 10.0f), FVector2f(60.0f, 30.0f) })
+	{
+		UE_LOG(LogTemp, Display, TEXT("SimpleDayNight benchmark: %d days, Length of Day %.0f, Length of Seasons %.0f"), Days, Setting.X, Setting.Y);
+		Simulations.Add(MakeShared<FJsonValueObject>(RunSimulation(Setting.X, Setting.Y, Days)));
+	}
+	Results->SetArrayField(TEXT("Simulations"), Simulations);
+
+	Results->SetNumberField(TEXT("Checksum"), BenchmarkChecksum);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Results, Writer);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimpleDayNight benchmark: couldn't write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("SimpleDayNight benchmark: results written to %s"), *OutputPath);
+	return 0;
+}
+
+TSharedRef<FJsonObject> USimpleDayNightBenchmarkCommandlet::RunMathBenchmarks() const
+{
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+
+	const int32 Iterations = 1000000;
+	const double Step = 24.0 / (10.0 * 60.0) / 60.0;
+	FSimpleDayNightEphemerisParams Params;
+
+	//Times Iterations calls of Body, each a frame's worth of in-game time after the last
+	auto TimeCalls = [&](const TCHAR* Name, TFunctionRef<double(const FSimpleDayNightTime&)> Body)
+	{
+		FSimpleDayNightTime Time(0, 6.0);
+		const double Start = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Iterations; ++Index)
+		{
+			Time.AddHours(Step);
+			BenchmarkChecksum += Body(Time);
+		}
+		Results->SetNumberField(Name, (FPlatformTime::Seconds() - Start) * 1e9 / Iterations);
+	};
+
+	TimeCalls(TEXT("SunDirectionNs"), [&](const FSimpleDayNightTime& Time)
+	{
+		return FSimpleDayNightEphemeris::GetSunDirection(Time, Params).Z;
+	});
+
+	TimeCalls(TEXT("EvaluateNs"), [&](const FSimpleDayNightTime& Time)
+	{
+		return FSimpleDayNightEphemeris::Evaluate(Time, Params).Stars.W;
+	});
+
+	FSimpleDayNightOrientationCache Cache;
+	Cache.SetKeysPerDay(96);
+	TimeCalls(TEXT("CacheSampleNs"), [&](const FSimpleDayNightTime& Time)
+	{
+		Cache.Prefetch(2);
+		return Cache.Sample(Time, Params).Stars.W;
+	});
+
+	FSimpleDayNightEventScheduler Scheduler;
+	for (ECelestialEvent Event : TEnumRange<ECelestialEvent>())
+	{
+		Scheduler.Register(Event, 0.0, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateLambda([](ECelestialEvent, double)
+		{
+			BenchmarkChecksum += 1.0;
+		}));
+	}
+	TimeCalls(TEXT("EventAdvanceNs"), [&](const FSimpleDayNightTime& Time)
+	{
+		Scheduler.AdvanceTo(Time, Params);
+		return 0.0;
+	});
+
+	//Batch cost is per sample.
+	FSimpleDayNightEphemerisBatch Batch;
+	for (int32 Index = 0; Index < 1024; ++Index)
+	{
+		Batch.Add(FSimpleDayNightTime(Index / 96, (Index % 96) * 0.25), -60.0f + (Index % 120));
+	}
+	const int32 BatchIterations = Iterations / Batch.Num();
+	const double BatchStart = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < BatchIterations; ++Index)
+	{
+		FSimpleDayNightEphemeris::EvaluateBatch(Batch, Params.AxialTilt, Params.SeasonLength);
+		BenchmarkChecksum += Batch.SunDirectionZ[Index % Batch.Num()];
+	}
+	Results->SetNumberField(TEXT("BatchPerSampleNs"), (FPlatformTime::Seconds() - BatchStart) * 1e9 / (BatchIterations * Batch.Num()));
+
+	//A moon and a handful of planets, as the controller evaluates them on every sun commit.
+	FSimpleDayNightBodyBatch Bodies;
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		Bodies.Add(FSimpleDayNightBodyOrbit{ 29.5 + Index * 40.0, Index * 0.13, Index * 1.5 });
+	}
+	TimeCalls(TEXT("BodiesNs"), [&](const FSimpleDayNightTime& Time)
+	{
+		FSimpleDayNightEphemeris::EvaluateBodies(Bodies, Time, Params);
+		return (double)Bodies.DirectionZ[0];
+	});
+
+	return Results;
+}
+
+TSharedRef<FJsonObject> USimpleDayNightBenchmarkCommandlet::RunStarCatalogBenchmark() const
+{
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+
+	//About the size of HYG, with magnitudes spread like a real sky (each magnitude has about three times as many stars as the last).
+	const int32 NumStars = 120000;
+	FRandomStream Random(1234);
+	TArray<FSimpleDayNightStarCatalog::FStar> Stars;
+	Stars.SetNum(NumStars);
+	for (FSimpleDayNightStarCatalog::FStar& Star : Stars)
+	{
+		Star.Direction = FVector3f(Random.GetUnitVector());
+		Star.Magnitude = 12.0f - FMath::Loge(1.0f + Random.FRand() * 1e5f) / FMath::Loge(3.0f);
+		Star.ColorIndex = Random.FRandRange(-0.3f, 2.0f);
+	}
+
+	TArray<uint8> Bytes;
+	FSimpleDayNightStarCatalog::Write(Stars, Bytes);
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("SimpleDayNight") / TEXT("Benchmark.sdnstars");
+	FFileHelper::SaveArrayToFile(Bytes, *Filename);
+	Results->SetNumberField(TEXT("Stars"), NumStars);
+	Results->SetNumberField(TEXT("FileBytes"), Bytes.Num());
+
+	FSimpleDayNightStarCatalog Catalog;
+	double Start = FPlatformTime::Seconds();
+	Catalog.Load(Filename);
+	Results->SetNumberField(TEXT("LoadMs"), (FPlatformTime::Seconds() - Start) * 1000.0);
+	Results->SetBoolField(TEXT("Mapped"), Catalog.IsMapped());
+	Results->SetNumberField(TEXT("HeapBytes"), Catalog.GetAllocatedSize());
+
+	Start = FPlatformTime::Seconds();
+	TArray<uint8> ReadBytes;
+	FFileHelper::LoadFileToArray(ReadBytes, *Filename);
+	FSimpleDayNightStarCatalog ReadCatalog;
+	ReadCatalog.LoadFromMemory(MoveTemp(ReadBytes));
+	Results->SetNumberField(TEXT("ReadInMs"), (FPlatformTime::Seconds() - Start) * 1000.0);
+
+	TArray<int32> Indices;
+	for (const float MagnitudeLimit : { 4.5f, 6.5f, 8.0f })
+	{
+		Start = FPlatformTime::Seconds();
+		Catalog.Cull(MagnitudeLimit, FVector3f::ZeroVector, -1.0f, Indices);
+		Results->SetNumberField(FString::Printf(TEXT("CullMagnitude%.1fMs"), MagnitudeLimit), (FPlatformTime::Seconds() - Start) * 1000.0);
+		Results->SetNumberField(FString::Printf(TEXT("StarsMagnitude%.1f"), MagnitudeLimit), Indices.Num());
+	}
+
+	//A 10 degree telescope view.
+	Start = FPlatformTime::Seconds();
+	Catalog.Cull(12.0f, FVector3f::UpVector, FMath::Cos(FMath::DegreesToRadians(10.0f)), Indices);
+	Results->SetNumberField(TEXT("CullViewMs"), (FPlatformTime::Seconds() - Start) * 1000.0);
+	Results->SetNumberField(TEXT("StarsView"), Indices.Num());
+	BenchmarkChecksum += Indices.Num();
+
+	Catalog.Reset();
+	IFileManager::Get().Delete(*Filename);
+
+	return Results;
+}
+
+TSharedRef<FJsonObject> USimpleDayNightBenchmarkCommandlet::RunControllerBenchmark(int32 NumControllers) const
+{
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+	Results->SetNumberField(TEXT("Controllers"), NumControllers);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SimpleDayNightBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	TArray<ADayNightController*> Controllers;
+	for (int32 Index = 0; Index < NumControllers; ++Index)
+	{
+		Controllers.Add(World->SpawnActor<ADayNightController>());
+	}
+
+	const float DeltaTime = 1.0f / 60.0f;
+	const int32 WarmupFrames = 30;
+	const int32 Frames = 300;
+
+	//Whole frames, with whatever update mode the project settings pick.
+	double Start = 0.0;
+	for (int32 Frame = 0; Frame < WarmupFrames + Frames; ++Frame)
+	{
+		if (Frame == WarmupFrames)
+		{
+			Start = FPlatformTime::Seconds();
+		}
+
+		//There's no engine loop in a commandlet, and the subsystem only advances once per frame.
+		++GFrameCounter;
+		World->Tick(LEVELTICK_All, DeltaTime);
+	}
+	const double FrameSeconds = (FPlatformTime::Seconds() - Start) / Frames;
+	Results->SetNumberField(TEXT("FrameMs"), FrameSeconds * 1e3);
+	Results->SetNumberField(TEXT("TickPerControllerUs"), FrameSeconds * 1e6 / NumControllers);
+
+	//Forced sun and star updates on every controller, which is what smooth update costs per frame.
+	const int32 Updates = FMath::Max(10, 10000 / NumControllers);
+	Start = FPlatformTime::Seconds();
+	for (int32 Update = 0; Update < Updates; ++Update)
+	{
+		for (ADayNightController* Controller : Controllers)
+		{
+			Controller->UpdateSunPosition();
+		}
+	}
+	Results->SetNumberField(TEXT("SunUpdateUs"), (FPlatformTime::Seconds() - Start) * 1e6 / (Updates * NumControllers));
+
+	Start = FPlatformTime::Seconds();
+	for (int32 Update = 0; Update < Updates; ++Update)
+	{
+		for (ADayNightController* Controller : Controllers)
+		{
+			Controller->UpdateStarPosition();
+		}
+	}
+	Results->SetNumberField(TEXT("StarUpdateUs"), (FPlatformTime::Seconds() - Start) * 1e6 / (Updates * NumControllers));
+
+	int64 SunCommits = 0;
+	for (ADayNightController* Controller : Controllers)
+	{
+		SunCommits += Controller->SunCommits;
+	}
+	Results->SetNumberField(TEXT("SunCommits"), (double)SunCommits);
+
+	if (const USimpleDayNightSubsystem* DayNight = World->GetSubsystem<USimpleDayNightSubsystem>())
+	{
+		BenchmarkChecksum += DayNight->GetTimeOfDay();
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return Results;
+}
+
+TSharedRef<FJsonObject> USimpleDayNightBenchmarkCommandlet::RunSimulation(float LengthOfDay, float SeasonLength, int32 Days) const
+{
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+	Results->SetNumberField(TEXT("LengthOfDay"), LengthOfDay);
+	Results->SetNumberField(TEXT("SeasonLength"), SeasonLength);
+	Results->SetNumberField(TEXT("Days"), Days);
+
+	FSimpleDayNightEphemerisParams Params;
+	Params.SeasonLength = SeasonLength;
+
+	FSimpleDayNightEventScheduler Scheduler;
+	int32 EventsFired = 0;
+	for (ECelestialEvent Event : TEnumRange<ECelestialEvent>())
+	{
+		Scheduler.Register(Event, 0.0, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateLambda([&EventsFired](ECelestialEvent, double)
+		{
+			EventsFired++;
+		}));
+	}
+
+	//The default threshold and step, to see how many VSM invalidations a day each policy costs.
+	const double CosThreshold = FMath::Cos(FMath::DegreesToRadians(0.1));
+	const double SteppedInterval = 1.0;
+
+	const double DeltaTime = 1.0 / 60.0;
+	const double HoursPerFrame = DeltaTime * (24.0 / LengthOfDay / 60.0);
+	const int64 Frames = (int64)(Days * 24.0 / HoursPerFrame);
+
+	FSimpleDayNightTime Time(0, 6.0);
+	FVector LastThresholdCommit = FSimpleDayNightEphemeris::GetSunDirection(Time, Params);
+	int64 ThresholdCommits = 0;
+	int64 SteppedCommits = 0;
+	double SinceStep = 0.0;
+
+	Scheduler.AdvanceTo(Time, Params);
+
+	const double Start = FPlatformTime::Seconds();
+	for (int64 Frame = 0; Frame < Frames; ++Frame)
+	{
+		Time.AddHours(HoursPerFrame);
+		Scheduler.AdvanceTo(Time, Params);
+
+		const FVector SunDirection = FSimpleDayNightEphemeris::GetSunDirection(Time, Params);
+		if ((SunDirection | LastThresholdCommit) <= CosThreshold)
+		{
+			LastThresholdCommit = SunDirection;
+			ThresholdCommits++;
+		}
+
+		SinceStep += DeltaTime;
+		if (SinceStep >= SteppedInterval)
+		{
+			SinceStep -= SteppedInterval;
+			SteppedCommits++;
+		}
+	}
+	const double Seconds = FPlatformTime::Seconds() - Start;
+	BenchmarkChecksum += LastThresholdCommit.Z;
+
+	Results->SetNumberField(TEXT("Frames"), (double)Frames);
+	Results->SetNumberField(TEXT("TotalMs"), Seconds * 1e3);
+	Results->SetNumberField(TEXT("FrameNs"), Frames > 0 ? Seconds * 1e9 / Frames : 0.0);
+	Results->SetNumberField(TEXT("EventsFired"), EventsFired);
+	Results->SetNumberField(TEXT("SmoothCommitsPerDay"), (double)Frames / Days);
+	Results->SetNumberField(TEXT("SteppedCommitsPerDay"), (double)SteppedCommits / Days);
+	Results->SetNumberField(TEXT("ThresholdCommitsPerDay"), (double)ThresholdCommits / Days);
+
+	return Results;
+}
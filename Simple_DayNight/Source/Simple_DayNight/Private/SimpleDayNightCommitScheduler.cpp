@@ -0,0 +1,126 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightCommitScheduler.h"
+
+//How many frames the headroom budget is reused for before it is recomputed from the history
+static constexpr uint64 HeadroomBudgetLifetime = 16;
+
+FSimpleDayNightCommitScheduler::FSimpleDayNightCommitScheduler(int32 InHistorySize)
+{
+	FrameTimes.SetNumZeroed(FMath::Max(InHistorySize, 1));
+}
+
+void FSimpleDayNightCommitScheduler::AddFrameTime(float DeltaTime)
+{
+	FrameTimes[NextFrameTime] = DeltaTime;
+	NextFrameTime = (NextFrameTime + 1) % FrameTimes.Num();
+	NumFrameTimes = FMath::Min(NumFrameTimes + 1, FrameTimes.Num());
+
+	FrameNumber++;
+}
+
+void FSimpleDayNightCommitScheduler::RequestCommit()
+{
+	if (!bCommitPending)
+	{
+		bCommitPending = true;
+		PendingFrames = 0;
+	}
+}
+
+bool FSimpleDayNightCommitScheduler::ShouldCommit(int32 MaxDeferFrames, bool bDeadline)
+{
+	if (!bCommitPending)
+	{
+		return false;
+	}
+
+	//Never rebuild the VSMs on two frames in a row, even when the deadline has passed.
+	const bool bCommittedLastFrame = LastCommitFrame != 0 && LastCommitFrame + 1 >= FrameNumber;
+	const bool bForced = bDeadline || PendingFrames >= MaxDeferFrames;
+
+	if (!bCommittedLastFrame && (bForced || HasHeadroom()))
+	{
+		if (PendingFrames > 0)
+		{
+			DeferredCommits++;
+		}
+		if (bForced)
+		{
+			ForcedCommits++;
+		}
+		return true;
+	}
+
+	PendingFrames++;
+	DeferredFrames++;
+	return false;
+}
+
+void FSimpleDayNightCommitScheduler::NotifyCommitted()
+{
+	bCommitPending = false;
+	PendingFrames = 0;
+	LastCommitFrame = FrameNumber;
+}
+
+bool FSimpleDayNightCommitScheduler::HasHeadroom()
+{
+	if (NumFrameTimes == 0)
+	{
+		return true;
+	}
+
+	//The last frame is the best guess for the next one. If it was no slower than the median there's room for a VSM rebuild.
+	return GetLastFrameTime() <= GetMedianFrameTime();
+}
+
+float FSimpleDayNightCommitScheduler::GetMedianFrameTime() const
+{
+	if (HeadroomBudgetFrame == 0 || FrameNumber - HeadroomBudgetFrame >= HeadroomBudgetLifetime)
+	{
+		HeadroomBudget = GetFrameTimePercentile(50.0f);
+		HeadroomBudgetFrame = FrameNumber;
+	}
+	return HeadroomBudget;
+}
+
+float FSimpleDayNightCommitScheduler::GetLastFrameTime() const
+{
+	return NumFrameTimes > 0 ? FrameTimes[(NextFrameTime + FrameTimes.Num() - 1) % FrameTimes.Num()] : 0.0f;
+}
+
+float FSimpleDayNightCommitScheduler::GetFrameTimePercentile(float Percentile) const
+{
+	if (NumFrameTimes == 0)
+	{
+		return 0.0f;
+	}
+
+	//Until the ring buffer wraps the valid samples are the first NumFrameTimes entries.
+	TArray<float> Sorted(FrameTimes.GetData(), NumFrameTimes);
+	Sorted.Sort();
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(FMath::Clamp(Percentile, 0.0f, 100.0f) / 100.0f * NumFrameTimes) - 1, 0, NumFrameTimes - 1);
+	return Sorted[Index];
+}
@@ -0,0 +1,104 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightConfigWriter.h"
+#include "Misc/ConfigCacheIni.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+void FSimpleDayNightConfigWriter::SetValue(const FString& Filename, const FString& Section, const FString& Key, const FString& Value)
+{
+	check(IsInGameThread());
+
+	Pending.FindOrAdd(Filename).FindOrAdd(Section).Add(Key, Value);
+	RestartDelay();
+}
+
+void FSimpleDayNightConfigWriter::QueueFlush(const FString& ConfigFilename)
+{
+	check(IsInGameThread());
+
+	PendingFlushes.Add(ConfigFilename);
+	RestartDelay();
+}
+
+void FSimpleDayNightConfigWriter::RestartDelay()
+{
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FSimpleDayNightConfigWriter::Tick), SaveDelay);
+}
+
+void FSimpleDayNightConfigWriter::Flush()
+{
+	check(IsInGameThread());
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSimpleDayNightConfigWriter::Flush);
+
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+
+	NumWrites += Pending.Num() + PendingFlushes.Num();
+
+	for (const TPair<FString, TMap<FString, TMap<FString, FString>>>& File : Pending)
+	{
+		//Read what's on disk so other sections and keys are kept.
+		FConfigFile ConfigFile;
+		ConfigFile.Read(File.Key);
+
+		for (const TPair<FString, TMap<FString, FString>>& Section : File.Value)
+		{
+			for (const TPair<FString, FString>& Value : Section.Value)
+			{
+				ConfigFile.SetString(*Section.Key, *Value.Key, *Value.Value);
+			}
+		}
+
+		ConfigFile.Write(File.Key);
+	}
+	Pending.Reset();
+
+	for (const FString& ConfigFilename : PendingFlushes)
+	{
+		if (GConfig)
+		{
+			GConfig->Flush(false, ConfigFilename);
+		}
+	}
+	PendingFlushes.Reset();
+}
+
+bool FSimpleDayNightConfigWriter::Tick(float DeltaTime)
+{
+	TickerHandle.Reset();
+	Flush();
+	return false;
+}
+
+FSimpleDayNightConfigWriter& FSimpleDayNightConfigWriter::Get()
+{
+	static FSimpleDayNightConfigWriter Writer;
+	return Writer;
+}
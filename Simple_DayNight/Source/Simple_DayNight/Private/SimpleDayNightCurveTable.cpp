@@ -0,0 +1,135 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightCurveTable.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveLinearColor.h"
+
+void FSimpleDayNightCurveTable::Bake(const FSimpleDayNightSkyCurves& Curves, int32 ElevationSamples, int32 SeasonSamples)
+{
+	Reset();
+
+	const TPair<UCurveFloat*, EChannel> FloatCurves[] = {
+		{ Curves.SunIntensity, SunIntensity },
+		{ Curves.SunTemperature, SunTemperature },
+		{ Curves.RayleighScatteringScale, RayleighScatteringScale },
+		{ Curves.MieScatteringScale, MieScatteringScale }
+	};
+	const TPair<UCurveLinearColor*, EChannel> ColorCurves[] = {
+		{ Curves.SunColor, SunColorR },
+		{ Curves.SkyLuminanceFactor, SkyLuminanceR }
+	};
+
+	for (const TPair<UCurveFloat*, EChannel>& Curve : FloatCurves)
+	{
+		ChannelMask |= Curve.Key ? 1u << Curve.Value : 0u;
+	}
+	for (const TPair<UCurveLinearColor*, EChannel>& Curve : ColorCurves)
+	{
+		ChannelMask |= Curve.Key ? 7u << Curve.Value : 0u;
+	}
+
+	if (ChannelMask == 0)
+	{
+		return;
+	}
+
+	//Without a season curve every season would be the same, so there's only one.
+	NumElevations = FMath::Max(ElevationSamples, 2);
+	NumSeasons = Curves.SeasonScale ? FMath::Max(SeasonSamples, 1) : 1;
+	Values.SetNumZeroed(NumSeasons * NumElevations * NumChannels);
+
+	for (int32 Season = 0; Season < NumSeasons; ++Season)
+	{
+		const float SeasonScale = Curves.SeasonScale ? Curves.SeasonScale->GetFloatValue((float)Season / NumSeasons) : 1.0f;
+
+		for (int32 ElevationIndex = 0; ElevationIndex < NumElevations; ++ElevationIndex)
+		{
+			const float Elevation = -90.0f + 180.0f * ElevationIndex / (NumElevations - 1);
+			float* Sample = &Values[(Season * NumElevations + ElevationIndex) * NumChannels];
+
+			for (const TPair<UCurveFloat*, EChannel>& Curve : FloatCurves)
+			{
+				if (Curve.Key)
+				{
+					Sample[Curve.Value] = Curve.Key->GetFloatValue(Elevation);
+				}
+			}
+			for (const TPair<UCurveLinearColor*, EChannel>& Curve : ColorCurves)
+			{
+				if (Curve.Key)
+				{
+					const FLinearColor Color = Curve.Key->GetLinearColorValue(Elevation);
+					Sample[Curve.Value] = Color.R;
+					Sample[Curve.Value + 1] = Color.G;
+					Sample[Curve.Value + 2] = Color.B;
+				}
+			}
+
+			Sample[SunIntensity] *= SeasonScale;
+			Sample[SkyLuminanceR] *= SeasonScale;
+			Sample[SkyLuminanceG] *= SeasonScale;
+			Sample[SkyLuminanceB] *= SeasonScale;
+		}
+	}
+}
+
+void FSimpleDayNightCurveTable::Reset()
+{
+	Values.Empty();
+	ChannelMask = 0;
+	NumElevations = 0;
+	NumSeasons = 0;
+}
+
+void FSimpleDayNightCurveTable::Sample(double Elevation, double SeasonPhase, float* OutValues) const
+{
+	if (ChannelMask == 0)
+	{
+		return;
+	}
+
+	const double ElevationPosition = FMath::Clamp((Elevation + 90.0) / 180.0, 0.0, 1.0) * (NumElevations - 1);
+	const int32 Elevation0 = FMath::Min((int32)ElevationPosition, NumElevations - 2);
+	const float ElevationAlpha = (float)(ElevationPosition - Elevation0);
+
+	//Seasons wrap around the year.
+	const double SeasonPosition = FMath::Frac(SeasonPhase) * NumSeasons;
+	const int32 Season0 = FMath::Min((int32)SeasonPosition, NumSeasons - 1);
+	const int32 Season1 = (Season0 + 1) % NumSeasons;
+	const float SeasonAlpha = (float)(SeasonPosition - Season0);
+
+	const float* A = &Values[(Season0 * NumElevations + Elevation0) * NumChannels];
+	const float* B = A + NumChannels;
+	const float* C = &Values[(Season1 * NumElevations + Elevation0) * NumChannels];
+	const float* D = C + NumChannels;
+
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		if (ChannelMask & (1u << Channel))
+		{
+			const float Low = FMath::Lerp(A[Channel], B[Channel], ElevationAlpha);
+			const float High = FMath::Lerp(C[Channel], D[Channel], ElevationAlpha);
+			OutValues[Channel] = FMath::Lerp(Low, High, SeasonAlpha);
+		}
+	}
+}
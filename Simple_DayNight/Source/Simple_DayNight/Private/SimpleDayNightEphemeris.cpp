@@ -0,0 +1,370 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightEphemeris.h"
+
+FSimpleDayNightTime FSimpleDayNightTime::FromHours(double Hours)
+{
+	const double Days = FMath::FloorToDouble(Hours / 24.0);
+	return FSimpleDayNightTime((int64)Days, Hours - Days * 24.0);
+}
+
+double FSimpleDayNightTime::ToHours() const
+{
+	return (double)Day * 24.0 + Hour;
+}
+
+void FSimpleDayNightTime::AddHours(double Hours)
+{
+	Hour += Hours;
+	Normalize();
+}
+
+void FSimpleDayNightTime::Normalize()
+{
+	if (Hour < 0.0 || Hour >= 24.0)
+	{
+		const double WholeDays = FMath::FloorToDouble(Hour / 24.0);
+		Day += (int64)WholeDays;
+		Hour -= WholeDays * 24.0;
+
+		//Rounding can leave a hair under zero or exactly 24.
+		if (Hour >= 24.0)
+		{
+			Day++;
+			Hour -= 24.0;
+		}
+		Hour = FMath::Max(Hour, 0.0);
+	}
+}
+
+double FSimpleDayNightTime::HoursSince(const FSimpleDayNightTime& Other) const
+{
+	return (double)(Day - Other.Day) * 24.0 + (Hour - Other.Hour);
+}
+
+void FSimpleDayNightEphemerisBatch::Add(const FSimpleDayNightTime& Time, float Latitude)
+{
+	Days.Add(Time.Day);
+	Hours.Add(Time.Hour);
+	Latitudes.Add(Latitude);
+}
+
+void FSimpleDayNightEphemerisBatch::Reset()
+{
+	Days.Reset();
+	Hours.Reset();
+	Latitudes.Reset();
+}
+
+void FSimpleDayNightBodyBatch::Add(const FSimpleDayNightBodyOrbit& Orbit)
+{
+	SynodicPeriods.Add(Orbit.SynodicPeriod);
+	PhaseOffsets.Add(Orbit.PhaseOffset);
+	Inclinations.Add((float)Orbit.Inclination);
+}
+
+void FSimpleDayNightBodyBatch::Reset()
+{
+	SynodicPeriods.Reset();
+	PhaseOffsets.Reset();
+	Inclinations.Reset();
+}
+
+double FSimpleDayNightEphemeris::GetSeasonPhase(const FSimpleDayNightTime& Time, double SeasonLength)
+{
+	//A year is four seasons. Reduce the day count to the current year first so the fraction keeps full precision.
+	const double YearLength = SeasonLength * 4.0;
+	if (YearLength <= 0.0)
+	{
+		return 0.0;
+	}
+
+	//Clock starts at midnight before the Northern Winter Solstice, so the solstice itself is at noon.
+	const double DayOfYear = FMath::Fmod((double)Time.Day, YearLength);
+	const double Phase = (DayOfYear * 24.0 + Time.Hour - 12.0) / (YearLength * 24.0);
+	return Phase - FMath::FloorToDouble(Phase);
+}
+
+double FSimpleDayNightEphemeris::GetSunPitch(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	return Params.AxialTilt * FMath::Cos(GetSeasonPhase(Time, Params.SeasonLength) * 2.0 * PI);
+}
+
+FQuat FSimpleDayNightEphemeris::GetAxisRotation(const FSimpleDayNightTime& Time, double Latitude)
+{
+	//The Axis has North as its Z axis and East (rotated around North by the hour angle, Hour * 15 + 180) as its Y axis.
+	//That's the same as spinning (HourAngle - 90) degrees around Z, then tipping Z over to North by rotating (90 - Latitude) around X.
+	return FQuat(FVector::XAxisVector, FMath::DegreesToRadians(90.0 - Latitude)) *
+		FQuat(FVector::ZAxisVector, FMath::DegreesToRadians(Time.Hour * 15.0 + 90.0));
+}
+
+FQuat FSimpleDayNightEphemeris::GetSunRelativeRotation(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	return FRotator(GetSunPitch(Time, Params), 0, 0).Quaternion();
+}
+
+FQuat FSimpleDayNightEphemeris::GetStarRotation(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	//Same construction as the Axis, with the hour angle pushed along by the position in the year to fake seasonal procession of the stars.
+	//Star hour angle is Hour * 15 + SeasonPhase * 360 - 90.
+	const double SpinAngle = Time.Hour * 15.0 + GetSeasonPhase(Time, Params.SeasonLength) * 360.0 - 180.0;
+
+	return FQuat(FVector::XAxisVector, FMath::DegreesToRadians(90.0 - Params.Latitude)) *
+		FQuat(FVector::ZAxisVector, FMath::DegreesToRadians(SpinAngle));
+}
+
+FVector FSimpleDayNightEphemeris::GetSunDirection(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	//Closed form of the Sun's forward vector after pitching it by the seasonal wobble and rotating it onto the Axis basis.
+	double SinLat, CosLat, SinHour, CosHour, SinPitch, CosPitch;
+	FMath::SinCos(&SinLat, &CosLat, FMath::DegreesToRadians(Params.Latitude));
+	FMath::SinCos(&SinHour, &CosHour, FMath::DegreesToRadians(Time.Hour * 15.0 + 180.0));
+	FMath::SinCos(&SinPitch, &CosPitch, FMath::DegreesToRadians(GetSunPitch(Time, Params)));
+
+	return FVector(
+		CosPitch * SinHour,
+		-CosPitch * CosHour * SinLat - SinPitch * CosLat,
+		-CosPitch * CosHour * CosLat + SinPitch * SinLat);
+}
+
+double FSimpleDayNightEphemeris::GetSunElevation(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	//Sunlight travelling straight down means the sun is straight up.
+	return FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-GetSunDirection(Time, Params).Z, -1.0, 1.0)));
+}
+
+FSimpleDayNightOrientation FSimpleDayNightEphemeris::Evaluate(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	FSimpleDayNightOrientation Orientation;
+	Orientation.Axis = GetAxisRotation(Time, Params.Latitude);
+	Orientation.SunRelative = GetSunRelativeRotation(Time, Params);
+	Orientation.Stars = GetStarRotation(Time, Params);
+	Orientation.SunDirection = GetSunDirection(Time, Params);
+	Orientation.SunElevation = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-Orientation.SunDirection.Z, -1.0, 1.0)));
+	return Orientation;
+}
+
+void FSimpleDayNightEphemeris::EvaluateBatch(FSimpleDayNightEphemerisBatch& Batch, double AxialTilt, double SeasonLength)
+{
+	const int32 Num = Batch.Num();
+	check(Batch.Hours.Num() == Num && Batch.Latitudes.Num() == Num);
+
+	Batch.SunDirectionX.SetNumUninitialized(Num);
+	Batch.SunDirectionY.SetNumUninitialized(Num);
+	Batch.SunDirectionZ.SetNumUninitialized(Num);
+	Batch.SunElevation.SetNumUninitialized(Num);
+	Batch.StarRotationX.SetNumUninitialized(Num);
+	Batch.StarRotationY.SetNumUninitialized(Num);
+	Batch.StarRotationZ.SetNumUninitialized(Num);
+	Batch.StarRotationW.SetNumUninitialized(Num);
+
+	//Reducing the time needs doubles, so do it up front for every sample.
+	//Everything after works on angles within a couple of turns, which are fine as floats.
+	TArray<float> HourAngles;
+	TArray<float> SeasonAngles;
+	HourAngles.SetNumUninitialized(Num);
+	SeasonAngles.SetNumUninitialized(Num);
+
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const FSimpleDayNightTime Time(Batch.Days[Index], Batch.Hours[Index]);
+		HourAngles[Index] = (float)FMath::DegreesToRadians(Time.Hour * 15.0);
+		SeasonAngles[Index] = (float)(GetSeasonPhase(Time, SeasonLength) * 2.0 * PI);
+	}
+
+	const VectorRegister4Float Tilt = VectorSetFloat1((float)FMath::DegreesToRadians(AxialTilt));
+	const VectorRegister4Float DegreesToRadians = VectorSetFloat1(PI / 180.0f);
+	const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+	const VectorRegister4Float HalfPi = VectorSetFloat1(HALF_PI);
+	const VectorRegister4Float Pi = VectorSetFloat1(PI);
+
+	int32 Index = 0;
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		const VectorRegister4Float Latitude = VectorMultiply(VectorLoad(&Batch.Latitudes[Index]), DegreesToRadians);
+		const VectorRegister4Float HourAngle = VectorLoad(&HourAngles[Index]);
+		const VectorRegister4Float SeasonAngle = VectorLoad(&SeasonAngles[Index]);
+
+		VectorRegister4Float SinLat, CosLat, SinHour, CosHour, SinSeason, CosSeason, SinPitch, CosPitch;
+		VectorSinCos(&SinLat, &CosLat, &Latitude);
+		VectorSinCos(&SinHour, &CosHour, &HourAngle);
+		VectorSinCos(&SinSeason, &CosSeason, &SeasonAngle);
+
+		//The sun's hour angle is Hour * 15 + 180, which just flips the sign of the sine and cosine.
+		SinHour = VectorNegate(SinHour);
+		CosHour = VectorNegate(CosHour);
+
+		const VectorRegister4Float Pitch = VectorMultiply(Tilt, CosSeason);
+		VectorSinCos(&SinPitch, &CosPitch, &Pitch);
+
+		//Same closed form as GetSunDirection.
+		const VectorRegister4Float CosPitchCosHour = VectorMultiply(CosPitch, CosHour);
+		VectorStore(VectorMultiply(CosPitch, SinHour), &Batch.SunDirectionX[Index]);
+		VectorStore(VectorNegate(VectorMultiplyAdd(CosPitchCosHour, SinLat, VectorMultiply(SinPitch, CosLat))), &Batch.SunDirectionY[Index]);
+		VectorStore(VectorSubtract(VectorMultiply(SinPitch, SinLat), VectorMultiply(CosPitchCosHour, CosLat)), &Batch.SunDirectionZ[Index]);
+
+		//Same rotations as GetStarRotation, multiplied out: (90 - Latitude) around X after (HourAngle + SeasonAngle - 180) around Z.
+		const VectorRegister4Float TipAngle = VectorMultiply(VectorSubtract(HalfPi, Latitude), Half);
+		const VectorRegister4Float SpinAngle = VectorMultiply(VectorSubtract(VectorAdd(HourAngle, SeasonAngle), Pi), Half);
+
+		VectorRegister4Float SinTip, CosTip, SinSpin, CosSpin;
+		VectorSinCos(&SinTip, &CosTip, &TipAngle);
+		VectorSinCos(&SinSpin, &CosSpin, &SpinAngle);
+
+		VectorStore(VectorMultiply(SinTip, CosSpin), &Batch.StarRotationX[Index]);
+		VectorStore(VectorNegate(VectorMultiply(SinTip, SinSpin)), &Batch.StarRotationY[Index]);
+		VectorStore(VectorMultiply(CosTip, SinSpin), &Batch.StarRotationZ[Index]);
+		VectorStore(VectorMultiply(CosTip, CosSpin), &Batch.StarRotationW[Index]);
+	}
+
+	//Whatever doesn't fill a whole vector goes through the scalar path.
+	for (; Index < Num; ++Index)
+	{
+		const FSimpleDayNightTime Time(Batch.Days[Index], Batch.Hours[Index]);
+		const FSimpleDayNightEphemerisParams Params{ Batch.Latitudes[Index], AxialTilt, SeasonLength };
+
+		const FVector SunDirection = GetSunDirection(Time, Params);
+		Batch.SunDirectionX[Index] = (float)SunDirection.X;
+		Batch.SunDirectionY[Index] = (float)SunDirection.Y;
+		Batch.SunDirectionZ[Index] = (float)SunDirection.Z;
+
+		const FQuat StarRotation = GetStarRotation(Time, Params);
+		Batch.StarRotationX[Index] = (float)StarRotation.X;
+		Batch.StarRotationY[Index] = (float)StarRotation.Y;
+		Batch.StarRotationZ[Index] = (float)StarRotation.Z;
+		Batch.StarRotationW[Index] = (float)StarRotation.W;
+	}
+
+	for (Index = 0; Index < Num; ++Index)
+	{
+		Batch.SunElevation[Index] = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-Batch.SunDirectionZ[Index], -1.0f, 1.0f)));
+	}
+}
+
+double FSimpleDayNightEphemeris::GetBodyPhase(const FSimpleDayNightTime& Time, const FSimpleDayNightBodyOrbit& Orbit)
+{
+	double Phase = Orbit.PhaseOffset;
+	if (Orbit.SynodicPeriod > 0.0)
+	{
+		//Same as the season phase, reduce the day count to the current lap first to keep the precision.
+		const double DayOfLap = FMath::Fmod((double)Time.Day, Orbit.SynodicPeriod);
+		Phase += (DayOfLap + Time.Hour / 24.0) / Orbit.SynodicPeriod;
+	}
+	return Phase - FMath::FloorToDouble(Phase);
+}
+
+FVector FSimpleDayNightEphemeris::GetBodyDirection(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params, const FSimpleDayNightBodyOrbit& Orbit)
+{
+	const double PhaseAngle = GetBodyPhase(Time, Orbit) * 2.0 * PI;
+	const double SeasonAngle = GetSeasonPhase(Time, Params.SeasonLength) * 2.0 * PI;
+	const double Pitch = Params.AxialTilt * FMath::Cos(SeasonAngle + PhaseAngle) + Orbit.Inclination * FMath::Sin(PhaseAngle);
+
+	//Same closed form as GetSunDirection, with the hour angle held back by the phase.
+	double SinLat, CosLat, SinHour, CosHour, SinPitch, CosPitch;
+	FMath::SinCos(&SinLat, &CosLat, FMath::DegreesToRadians(Params.Latitude));
+	FMath::SinCos(&SinHour, &CosHour, FMath::DegreesToRadians(Time.Hour * 15.0 + 180.0) - PhaseAngle);
+	FMath::SinCos(&SinPitch, &CosPitch, FMath::DegreesToRadians(Pitch));
+
+	return FVector(
+		CosPitch * SinHour,
+		-CosPitch * CosHour * SinLat - SinPitch * CosLat,
+		-CosPitch * CosHour * CosLat + SinPitch * SinLat);
+}
+
+void FSimpleDayNightEphemeris::EvaluateBodies(FSimpleDayNightBodyBatch& Batch, const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	const int32 Num = Batch.Num();
+	check(Batch.PhaseOffsets.Num() == Num && Batch.Inclinations.Num() == Num);
+
+	Batch.DirectionX.SetNumUninitialized(Num);
+	Batch.DirectionY.SetNumUninitialized(Num);
+	Batch.DirectionZ.SetNumUninitialized(Num);
+	Batch.Elevation.SetNumUninitialized(Num);
+	Batch.Phase.SetNumUninitialized(Num);
+	Batch.Illumination.SetNumUninitialized(Num);
+
+	//The phases need doubles, so work them out up front. Everything after is angles within a couple of turns.
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const FSimpleDayNightBodyOrbit Orbit{ Batch.SynodicPeriods[Index], Batch.PhaseOffsets[Index], Batch.Inclinations[Index] };
+		Batch.Phase[Index] = (float)GetBodyPhase(Time, Orbit);
+	}
+
+	//Shared by every body.
+	double SinLat, CosLat;
+	FMath::SinCos(&SinLat, &CosLat, FMath::DegreesToRadians(Params.Latitude));
+	const float SunHourAngle = (float)FMath::DegreesToRadians(Time.Hour * 15.0 + 180.0);
+	const float SeasonAngle = (float)(GetSeasonPhase(Time, Params.SeasonLength) * 2.0 * PI);
+
+	const VectorRegister4Float VecSinLat = VectorSetFloat1((float)SinLat);
+	const VectorRegister4Float VecCosLat = VectorSetFloat1((float)CosLat);
+	const VectorRegister4Float VecSunHourAngle = VectorSetFloat1(SunHourAngle);
+	const VectorRegister4Float VecSeasonAngle = VectorSetFloat1(SeasonAngle);
+	const VectorRegister4Float Tilt = VectorSetFloat1((float)FMath::DegreesToRadians(Params.AxialTilt));
+	const VectorRegister4Float DegreesToRadians = VectorSetFloat1(PI / 180.0f);
+	const VectorRegister4Float TwoPi = VectorSetFloat1(2.0f * PI);
+	const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+
+	int32 Index = 0;
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		const VectorRegister4Float PhaseAngle = VectorMultiply(VectorLoad(&Batch.Phase[Index]), TwoPi);
+		const VectorRegister4Float Inclination = VectorMultiply(VectorLoad(&Batch.Inclinations[Index]), DegreesToRadians);
+		const VectorRegister4Float HourAngle = VectorSubtract(VecSunHourAngle, PhaseAngle);
+		const VectorRegister4Float WobbleAngle = VectorAdd(VecSeasonAngle, PhaseAngle);
+
+		VectorRegister4Float SinPhase, CosPhase, SinHour, CosHour, SinWobble, CosWobble, SinPitch, CosPitch;
+		VectorSinCos(&SinPhase, &CosPhase, &PhaseAngle);
+		VectorSinCos(&SinHour, &CosHour, &HourAngle);
+		VectorSinCos(&SinWobble, &CosWobble, &WobbleAngle);
+
+		const VectorRegister4Float Pitch = VectorMultiplyAdd(Tilt, CosWobble, VectorMultiply(Inclination, SinPhase));
+		VectorSinCos(&SinPitch, &CosPitch, &Pitch);
+
+		//Same closed form as GetBodyDirection.
+		const VectorRegister4Float CosPitchCosHour = VectorMultiply(CosPitch, CosHour);
+		VectorStore(VectorMultiply(CosPitch, SinHour), &Batch.DirectionX[Index]);
+		VectorStore(VectorNegate(VectorMultiplyAdd(CosPitchCosHour, VecSinLat, VectorMultiply(SinPitch, VecCosLat))), &Batch.DirectionY[Index]);
+		VectorStore(VectorSubtract(VectorMultiply(SinPitch, VecSinLat), VectorMultiply(CosPitchCosHour, VecCosLat)), &Batch.DirectionZ[Index]);
+
+		//Lit fraction of the disc is (1 - cos(phase)) / 2.
+		VectorStore(VectorMultiply(VectorSubtract(VectorOne(), CosPhase), Half), &Batch.Illumination[Index]);
+	}
+
+	//Whatever doesn't fill a whole vector goes through the scalar path.
+	for (; Index < Num; ++Index)
+	{
+		const FSimpleDayNightBodyOrbit Orbit{ Batch.SynodicPeriods[Index], Batch.PhaseOffsets[Index], Batch.Inclinations[Index] };
+
+		const FVector Direction = GetBodyDirection(Time, Params, Orbit);
+		Batch.DirectionX[Index] = (float)Direction.X;
+		Batch.DirectionY[Index] = (float)Direction.Y;
+		Batch.DirectionZ[Index] = (float)Direction.Z;
+		Batch.Illumination[Index] = (float)((1.0 - FMath::Cos(Batch.Phase[Index] * 2.0 * PI)) * 0.5);
+	}
+
+	for (Index = 0; Index < Num; ++Index)
+	{
+		Batch.Elevation[Index] = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-Batch.DirectionZ[Index], -1.0f, 1.0f)));
+	}
+}
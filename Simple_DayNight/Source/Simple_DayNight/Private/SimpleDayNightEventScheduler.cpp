@@ -0,0 +1,356 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightEventScheduler.h"
+
+namespace
+{
+	struct FEarlierEvent
+	{
+		template<typename T>
+		bool operator()(const T& A, const T& B) const
+		{
+			return A.Time < B.Time;
+		}
+	};
+
+	//Hours either side of noon the sun is up for, with the seasonal wobble taken at Around. False if the sun is up or down all day.
+	bool GetHalfDayLength(const FSimpleDayNightTime& Around, const FSimpleDayNightEphemerisParams& Params, double& OutHalfDayLength)
+	{
+		double SinLat, CosLat, SinPitch, CosPitch;
+		FMath::SinCos(&SinLat, &CosLat, FMath::DegreesToRadians(Params.Latitude));
+		FMath::SinCos(&SinPitch, &CosPitch, FMath::DegreesToRadians(FSimpleDayNightEphemeris::GetSunPitch(Around, Params)));
+
+		//Sine of the sun's elevation is CosPitch * CosLat * cos(15 * (Hour - 12)) - SinPitch * SinLat, so it crosses the horizon where
+		//cos(15 * (Hour - 12)) = tan(Pitch) * tan(Latitude).
+		const double Denominator = CosPitch * CosLat;
+		if (FMath::IsNearlyZero(Denominator))
+		{
+			return false;
+		}
+
+		const double CosHourAngle = (SinPitch * SinLat) / Denominator;
+		if (CosHourAngle < -1.0 || CosHourAngle > 1.0)
+		{
+			return false;
+		}
+
+		OutHalfDayLength = FMath::RadiansToDegrees(FMath::Acos(CosHourAngle)) / 15.0;
+		return true;
+	}
+
+	//Fraction of a year under which a seasonal event counts as the one just passed rather than one still to come
+	constexpr double SeasonPhaseEpsilon = 1e-9;
+
+	//Most days FindNextEvent will look ahead for a sunrise or sunset before giving up
+	int32 GetMaxSearchDays(const FSimpleDayNightEphemerisParams& Params)
+	{
+		return FMath::Clamp(FMath::CeilToInt(Params.SeasonLength * 4.0) + 2, 2, 4000);
+	}
+}
+
+FDelegateHandle FSimpleDayNightEventScheduler::Register(ECelestialEvent Event, double OffsetHours, FOnCelestialEvent::FDelegate Delegate)
+{
+	//Everything registered for the same event and offset shares one multicast delegate and one queue entry.
+	int32 SubscriptionIndex = INDEX_NONE;
+	for (auto It = Subscriptions.CreateConstIterator(); It; ++It)
+	{
+		if (It->Event == Event && It->OffsetHours == OffsetHours)
+		{
+			SubscriptionIndex = It.GetIndex();
+			break;
+		}
+	}
+
+	if (SubscriptionIndex == INDEX_NONE)
+	{
+		SubscriptionIndex = Subscriptions.Add(FSubscription{ Event, OffsetHours, FOnCelestialEvent(), NextSerial++ });
+
+		if (bScheduled)
+		{
+			Schedule(SubscriptionIndex, CurrentTime);
+		}
+	}
+
+	const FDelegateHandle Handle = Subscriptions[SubscriptionIndex].Delegate.Add(MoveTemp(Delegate));
+	HandleToSubscription.Add(Handle, SubscriptionIndex);
+	return Handle;
+}
+
+void FSimpleDayNightEventScheduler::Unregister(FDelegateHandle Handle)
+{
+	int32 SubscriptionIndex = INDEX_NONE;
+	if (!HandleToSubscription.RemoveAndCopyValue(Handle, SubscriptionIndex))
+	{
+		return;
+	}
+
+	FSubscription& Subscription = Subscriptions[SubscriptionIndex];
+	Subscription.Delegate.Remove(Handle);
+
+	//Its queue entry is left behind and skipped when it comes up, because the serial won't match anything.
+	if (!Subscription.Delegate.IsBound())
+	{
+		Subscriptions.RemoveAt(SubscriptionIndex);
+	}
+}
+
+void FSimpleDayNightEventScheduler::Reset()
+{
+	Queue.Reset();
+	bScheduled = false;
+}
+
+bool FSimpleDayNightEventScheduler::GetScheduledTime(FDelegateHandle Handle, FSimpleDayNightTime& OutTime) const
+{
+	const int32* SubscriptionIndex = HandleToSubscription.Find(Handle);
+	if (!SubscriptionIndex)
+	{
+		return false;
+	}
+
+	const uint32 Serial = Subscriptions[*SubscriptionIndex].Serial;
+	for (const FScheduledEvent& Scheduled : Queue)
+	{
+		if (Scheduled.Subscription == *SubscriptionIndex && Scheduled.Serial == Serial && !Scheduled.bRecheck)
+		{
+			OutTime = Scheduled.Time;
+			return true;
+		}
+	}
+	return false;
+}
+
+void FSimpleDayNightEventScheduler::Schedule(int32 SubscriptionIndex, const FSimpleDayNightTime& From)
+{
+	//Look for the event itself after From minus the offset, so the event plus the offset lands after From.
+	FSimpleDayNightTime SearchAfter = From;
+	SearchAfter.AddHours(-Subscriptions[SubscriptionIndex].OffsetHours);
+
+	Schedule(SubscriptionIndex, From, SearchAfter);
+}
+
+void FSimpleDayNightEventScheduler::Schedule(int32 SubscriptionIndex, const FSimpleDayNightTime& From, const FSimpleDayNightTime& SearchAfter)
+{
+	const FSubscription& Subscription = Subscriptions[SubscriptionIndex];
+
+	FScheduledEvent Scheduled;
+	Scheduled.Subscription = SubscriptionIndex;
+	Scheduled.Serial = Subscription.Serial;
+	Scheduled.bRecheck = true;
+
+	//Adding the offset back can round onto or before From, which would fire the same event twice. Move on to the next one if it does.
+	FSimpleDayNightTime After = SearchAfter;
+	for (int32 Attempt = 0; Attempt < 4 && Scheduled.bRecheck; ++Attempt)
+	{
+		if (!FindNextEvent(Subscription.Event, After, CurrentParams, Scheduled.EventTime))
+		{
+			break;
+		}
+
+		Scheduled.Time = Scheduled.EventTime;
+		Scheduled.Time.AddHours(Subscription.OffsetHours);
+		Scheduled.bRecheck = !(From < Scheduled.Time);
+		After = Scheduled.EventTime;
+	}
+
+	if (Scheduled.bRecheck)
+	{
+		//Polar day or night. Look again in a day, in case the season or the params change.
+		Scheduled.Time = From;
+		Scheduled.Time.AddHours(24.0);
+		Scheduled.EventTime = Scheduled.Time;
+	}
+
+	Queue.HeapPush(Scheduled, FEarlierEvent());
+}
+
+void FSimpleDayNightEventScheduler::Reschedule(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	Queue.Reset();
+	CurrentTime = Time;
+	CurrentParams = Params;
+	bScheduled = true;
+
+	for (auto It = Subscriptions.CreateConstIterator(); It; ++It)
+	{
+		Schedule(It.GetIndex(), Time);
+	}
+}
+
+void FSimpleDayNightEventScheduler::AdvanceTo(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	//Anything that makes the queue meaningless starts it over from the new time.
+	if (!bScheduled || Params != CurrentParams || Time < CurrentTime || Time.HoursSince(CurrentTime) > MaxCatchUpHours)
+	{
+		Reschedule(Time, Params);
+		return;
+	}
+
+	while (Queue.Num() > 0 && !(Time < Queue.HeapTop().Time))
+	{
+		FScheduledEvent Due;
+		Queue.HeapPop(Due, FEarlierEvent());
+
+		//Unregistered since it was queued.
+		if (!Subscriptions.IsValidIndex(Due.Subscription) || Subscriptions[Due.Subscription].Serial != Due.Serial)
+		{
+			continue;
+		}
+
+		CurrentTime = Due.Time;
+		if (Due.bRecheck)
+		{
+			Schedule(Due.Subscription, Due.Time);
+		}
+		else
+		{
+			Schedule(Due.Subscription, Due.Time, Due.EventTime);
+		}
+
+		if (!Due.bRecheck && bCollapsing)
+		{
+			Collapsed.Add(Due.Subscription, TPair<uint32, FSimpleDayNightTime>(Due.Serial, Due.Time));
+		}
+		else if (!Due.bRecheck)
+		{
+			//Copy the delegate, so handlers can register and unregister while it's broadcasting.
+			const FSubscription& Subscription = Subscriptions[Due.Subscription];
+			const FOnCelestialEvent Delegate = Subscription.Delegate;
+			Delegate.Broadcast(Subscription.Event, Subscription.OffsetHours);
+		}
+	}
+
+	CurrentTime = Time;
+}
+
+void FSimpleDayNightEventScheduler::BeginCollapse()
+{
+	bCollapsing = true;
+	Collapsed.Reset();
+}
+
+void FSimpleDayNightEventScheduler::EndCollapse()
+{
+	if (!bCollapsing)
+	{
+		return;
+	}
+	bCollapsing = false;
+
+	Collapsed.ValueSort([](const TPair<uint32, FSimpleDayNightTime>& A, const TPair<uint32, FSimpleDayNightTime>& B)
+	{
+		return A.Value < B.Value;
+	});
+
+	const TMap<int32, TPair<uint32, FSimpleDayNightTime>> ToFire = MoveTemp(Collapsed);
+	Collapsed.Reset();
+
+	for (const TPair<int32, TPair<uint32, FSimpleDayNightTime>>& Entry : ToFire)
+	{
+		//Skip anything unregistered in the meantime.
+		if (Subscriptions.IsValidIndex(Entry.Key) && Subscriptions[Entry.Key].Serial == Entry.Value.Key)
+		{
+			const FSubscription& Subscription = Subscriptions[Entry.Key];
+			const FOnCelestialEvent Delegate = Subscription.Delegate;
+			Delegate.Broadcast(Subscription.Event, Subscription.OffsetHours);
+		}
+	}
+}
+
+bool FSimpleDayNightEventScheduler::FindSunCrossing(bool bSunrise, int64 Day, const FSimpleDayNightEphemerisParams& Params, FSimpleDayNightTime& OutTime)
+{
+	//The seasonal wobble keeps moving during the day, so refine the crossing a few times using the wobble at the last estimate.
+	FSimpleDayNightTime Estimate(Day, 12.0);
+	for (int32 Iteration = 0; Iteration < 3; ++Iteration)
+	{
+		double HalfDayLength;
+		if (!GetHalfDayLength(Estimate, Params, HalfDayLength))
+		{
+			return false;
+		}
+		Estimate = FSimpleDayNightTime(Day, bSunrise ? 12.0 - HalfDayLength : 12.0 + HalfDayLength);
+	}
+
+	OutTime = Estimate;
+	return true;
+}
+
+bool FSimpleDayNightEventScheduler::FindNextEvent(ECelestialEvent Event, const FSimpleDayNightTime& After, const FSimpleDayNightEphemerisParams& Params, FSimpleDayNightTime& OutTime)
+{
+	switch (Event)
+	{
+	case ECelestialEvent::Noon:
+	case ECelestialEvent::Midnight:
+	{
+		OutTime = FSimpleDayNightTime(After.Day, Event == ECelestialEvent::Noon ? 12.0 : 0.0);
+		if (!(After < OutTime))
+		{
+			OutTime.Day++;
+		}
+		return true;
+	}
+
+	case ECelestialEvent::WinterSolstice:
+	case ECelestialEvent::SpringEquinox:
+	case ECelestialEvent::SummerSolstice:
+	case ECelestialEvent::AutumnEquinox:
+	{
+		if (Params.SeasonLength <= 0.0)
+		{
+			return false;
+		}
+
+		//Each season is a quarter of the year, starting with the Winter Solstice at phase 0.
+		const double TargetPhase = ((int32)Event - (int32)ECelestialEvent::WinterSolstice) * 0.25;
+		double PhaseToGo = TargetPhase - FSimpleDayNightEphemeris::GetSeasonPhase(After, Params.SeasonLength);
+		PhaseToGo -= FMath::FloorToDouble(PhaseToGo);
+
+		//Rounding can leave After a hair short of the event it was taken from, which isn't the next one.
+		if (PhaseToGo <= SeasonPhaseEpsilon)
+		{
+			PhaseToGo += 1.0;
+		}
+
+		OutTime = After;
+		OutTime.AddHours(PhaseToGo * Params.SeasonLength * 4.0 * 24.0);
+		return true;
+	}
+
+	case ECelestialEvent::Sunrise:
+	case ECelestialEvent::Sunset:
+	{
+		const int32 MaxSearchDays = GetMaxSearchDays(Params);
+		for (int32 DayOffset = 0; DayOffset <= MaxSearchDays; ++DayOffset)
+		{
+			if (FindSunCrossing(Event == ECelestialEvent::Sunrise, After.Day + DayOffset, Params, OutTime) && After < OutTime)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,161 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightOrientationCache.h"
+
+//Fewer keys than this and neighbouring keys would be too far apart to slerp between
+static constexpr int32 MinKeysPerDay = 4;
+
+void FSimpleDayNightOrientationCache::SetKeysPerDay(int32 InKeysPerDay)
+{
+	InKeysPerDay = FMath::Max(InKeysPerDay, MinKeysPerDay);
+	if (InKeysPerDay != KeysPerDay)
+	{
+		KeysPerDay = InKeysPerDay;
+		Invalidate();
+	}
+}
+
+void FSimpleDayNightOrientationCache::Invalidate()
+{
+	bValid = false;
+	Axis.Reset();
+	Current = FDayTable();
+	Next = FDayTable();
+}
+
+SIZE_T FSimpleDayNightOrientationCache::GetAllocatedSize() const
+{
+	return Axis.GetAllocatedSize() +
+		Current.SunRelative.GetAllocatedSize() + Current.Stars.GetAllocatedSize() +
+		Next.SunRelative.GetAllocatedSize() + Next.Stars.GetAllocatedSize();
+}
+
+FSimpleDayNightTime FSimpleDayNightOrientationCache::GetKeyTime(int64 Day, int32 Key) const
+{
+	//The last key is midnight at the end of the day, so every hour has a key on either side of it.
+	return FSimpleDayNightTime(Day, 24.0 * Key / KeysPerDay);
+}
+
+void FSimpleDayNightOrientationCache::StartTable(FDayTable& Table, int64 Day) const
+{
+	Table.Day = Day;
+	Table.NumBuilt = 0;
+	Table.SunRelative.SetNumUninitialized(KeysPerDay + 1);
+	Table.Stars.SetNumUninitialized(KeysPerDay + 1);
+}
+
+void FSimpleDayNightOrientationCache::BuildKeys(FDayTable& Table, int32 MaxKeys) const
+{
+	const int32 End = FMath::Min(Table.NumBuilt + MaxKeys, Table.SunRelative.Num());
+	for (int32 Key = Table.NumBuilt; Key < End; ++Key)
+	{
+		const FSimpleDayNightTime KeyTime = GetKeyTime(Table.Day, Key);
+		Table.SunRelative[Key] = FSimpleDayNightEphemeris::GetSunRelativeRotation(KeyTime, CachedParams);
+		Table.Stars[Key] = FSimpleDayNightEphemeris::GetStarRotation(KeyTime, CachedParams);
+	}
+	Table.NumBuilt = End;
+}
+
+FSimpleDayNightOrientation FSimpleDayNightOrientationCache::Sample(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params)
+{
+	if (!bValid || Params != CachedParams)
+	{
+		Invalidate();
+		CachedParams = Params;
+
+		Axis.SetNumUninitialized(KeysPerDay + 1);
+		for (int32 Key = 0; Key <= KeysPerDay; ++Key)
+		{
+			Axis[Key] = FSimpleDayNightEphemeris::GetAxisRotation(GetKeyTime(0, Key), Params.Latitude);
+		}
+		bValid = true;
+	}
+
+	if (!Current.IsComplete() || Current.Day != Time.Day)
+	{
+		//Use the prefetched table if it's for this day, otherwise build the whole table now.
+		if (Next.Day == Time.Day && Next.NumBuilt > 0)
+		{
+			Swap(Current, Next);
+			Next = FDayTable();
+		}
+		else
+		{
+			StartTable(Current, Time.Day);
+		}
+		BuildKeys(Current, KeysPerDay + 1);
+	}
+
+	const double KeyPosition = Time.Hour / 24.0 * KeysPerDay;
+	const int32 Key = FMath::Clamp(FMath::FloorToInt(KeyPosition), 0, KeysPerDay - 1);
+	const double Alpha = KeyPosition - Key;
+
+	FSimpleDayNightOrientation Orientation;
+	Orientation.Axis = FQuat::Slerp(Axis[Key], Axis[Key + 1], Alpha);
+	Orientation.SunRelative = FQuat::Slerp(Current.SunRelative[Key], Current.SunRelative[Key + 1], Alpha);
+	Orientation.Stars = FQuat::Slerp(Current.Stars[Key], Current.Stars[Key + 1], Alpha);
+	Orientation.SunDirection = (Orientation.Axis * Orientation.SunRelative).GetForwardVector();
+	Orientation.SunElevation = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-Orientation.SunDirection.Z, -1.0, 1.0)));
+	return Orientation;
+}
+
+void FSimpleDayNightOrientationCache::Prefetch(int32 MaxKeys)
+{
+	if (!bValid || !Current.IsComplete())
+	{
+		return;
+	}
+
+	if (Next.Day != Current.Day + 1 || Next.SunRelative.Num() != KeysPerDay + 1)
+	{
+		StartTable(Next, Current.Day + 1);
+	}
+
+	if (!Next.IsComplete())
+	{
+		BuildKeys(Next, MaxKeys);
+	}
+}
+
+double FSimpleDayNightOrientationCache::MeasureMaxAngularError(const FSimpleDayNightEphemerisParams& Params, int64 Day, int32 KeysPerDay, int32 SamplesPerKey)
+{
+	FSimpleDayNightOrientationCache Cache;
+	Cache.SetKeysPerDay(KeysPerDay);
+
+	const int32 NumSamples = Cache.GetKeysPerDay() * FMath::Max(SamplesPerKey, 1);
+
+	double MaxError = 0.0;
+	for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+	{
+		const FSimpleDayNightTime Time(Day, 24.0 * (Sample + 0.5) / NumSamples);
+
+		const FSimpleDayNightOrientation Cached = Cache.Sample(Time, Params);
+		const FSimpleDayNightOrientation Analytic = FSimpleDayNightEphemeris::Evaluate(Time, Params);
+
+		MaxError = FMath::Max(MaxError, Cached.Axis.AngularDistance(Analytic.Axis));
+		MaxError = FMath::Max(MaxError, Cached.SunRelative.AngularDistance(Analytic.SunRelative));
+		MaxError = FMath::Max(MaxError, Cached.Stars.AngularDistance(Analytic.Stars));
+	}
+
+	return FMath::RadiansToDegrees(MaxError);
+}
@@ -0,0 +1,122 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightReplicatedClock.h"
+#include "Serialization/BitWriter.h"
+
+//Hours per step of the quantized epoch hour
+static constexpr double HourQuantum = 24.0 / 4294967296.0;
+
+//Day as a zigzag packed int, so early days only take a byte, and the hour as a 32 bit fraction of a day
+static void SerializeTime(FArchive& Ar, int64& Day, double& Hour)
+{
+	uint32 PackedDay = 0;
+	if (Ar.IsSaving())
+	{
+		const int32 ClampedDay = (int32)FMath::Clamp<int64>(Day, MIN_int32, MAX_int32);
+		PackedDay = ((uint32)ClampedDay << 1) ^ (uint32)(ClampedDay >> 31);
+	}
+	Ar.SerializeIntPacked(PackedDay);
+
+	uint32 QuantizedHour = 0;
+	if (Ar.IsSaving())
+	{
+		QuantizedHour = (uint32)FMath::Clamp<double>(FMath::RoundToDouble(Hour / HourQuantum), 0.0, (double)MAX_uint32);
+	}
+	Ar << QuantizedHour;
+
+	if (Ar.IsLoading())
+	{
+		Day = (int32)((PackedDay >> 1) ^ (0u - (PackedDay & 1)));
+		Hour = QuantizedHour * HourQuantum;
+	}
+}
+
+FSimpleDayNightTime FSimpleDayNightReplicatedClock::Extrapolate(double ServerTime) const
+{
+	FSimpleDayNightTime Time(EpochDay, EpochHour);
+	const double HoursPerSecond = LengthOfDay > 0.0f ? 24.0 / LengthOfDay / 60.0 : 0.0;
+
+	if (IsWarping())
+	{
+		//Straight from the epoch to the target, then on at the normal rate.
+		const FSimpleDayNightTime Target = GetWarpTarget();
+		if (ServerTime < WarpEndServerTime)
+		{
+			Time.AddHours(Target.HoursSince(Time) * (ServerTime - EpochServerTime) / (WarpEndServerTime - EpochServerTime));
+			return Time;
+		}
+
+		Time = Target;
+		Time.AddHours((ServerTime - WarpEndServerTime) * HoursPerSecond);
+		return Time;
+	}
+
+	Time.AddHours((ServerTime - EpochServerTime) * HoursPerSecond);
+	return Time;
+}
+
+int32 FSimpleDayNightReplicatedClock::GetSerializedSize() const
+{
+	FBitWriter Writer(0, true);
+	bool bSuccess = true;
+	const_cast<FSimpleDayNightReplicatedClock*>(this)->NetSerialize(Writer, nullptr, bSuccess);
+	return (int32)Writer.GetNumBytes();
+}
+
+float FSimpleDayNightReplicatedClock::GetCorrectionTime(double ErrorHours, float CorrectionTime, double SnapHours)
+{
+	//A small error is closed with a small change in the sun's speed rather than a jump.
+	return FMath::Abs(ErrorHours) >= SnapHours ? 0.0f : FMath::Max(CorrectionTime, 0.0f);
+}
+
+bool FSimpleDayNightReplicatedClock::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	SerializeTime(Ar, EpochDay, EpochHour);
+
+	Ar << EpochServerTime;
+	Ar << LengthOfDay;
+	Ar << SeasonLength;
+
+	//The warp only costs a byte and a bit unless one is running.
+	Ar << WarpSerial;
+
+	uint8 bWarping = IsWarping() ? 1 : 0;
+	Ar.SerializeBits(&bWarping, 1);
+
+	if (bWarping)
+	{
+		SerializeTime(Ar, WarpTargetDay, WarpTargetHour);
+		Ar << WarpEndServerTime;
+
+		uint8 bCollapse = bCollapseWarpEvents ? 1 : 0;
+		Ar.SerializeBits(&bCollapse, 1);
+		bCollapseWarpEvents = bCollapse != 0;
+	}
+	else if (Ar.IsLoading())
+	{
+		WarpEndServerTime = 0.0;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
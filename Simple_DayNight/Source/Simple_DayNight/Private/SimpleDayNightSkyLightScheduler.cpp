@@ -0,0 +1,110 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightSkyLightScheduler.h"
+#include "SimpleDayNightCommitScheduler.h"
+
+//Below astronomical twilight the sky doesn't change any more, so elevations are clamped to it before comparing
+static constexpr double NightElevation = -18.0;
+
+void FSimpleDayNightSkyLightScheduler::NotifySunCommitted(uint64 Frame, double Elevation, const FLinearColor& Color, float ElevationThreshold, float ColorThreshold)
+{
+	LastSunCommitFrame = Frame;
+
+	if (bRecapturePending)
+	{
+		return;
+	}
+
+	const double ElevationChange = FMath::Abs(FMath::Max(Elevation, NightElevation) - FMath::Max(CapturedElevation, NightElevation));
+	const float ColorChange = FMath::Max3(FMath::Abs(Color.R - CapturedColor.R), FMath::Abs(Color.G - CapturedColor.G), FMath::Abs(Color.B - CapturedColor.B));
+
+	if (!bHasCaptured || ElevationChange >= ElevationThreshold || ColorChange >= ColorThreshold)
+	{
+		bRecapturePending = true;
+		PendingFrames = 0;
+	}
+	else
+	{
+		SkippedRecaptures++;
+	}
+
+	//Remember what the sun was doing when the recapture became due, that's what it's compared against next.
+	if (bRecapturePending)
+	{
+		bHasCaptured = true;
+		CapturedElevation = Elevation;
+		CapturedColor = Color;
+	}
+}
+
+bool FSimpleDayNightSkyLightScheduler::ShouldRecapture(const FSimpleDayNightCommitScheduler& Frames, int32 MaxDeferFrames)
+{
+	if (!bRecapturePending)
+	{
+		return false;
+	}
+
+	//Keep the capture off the frame the VSMs are rebuilt on and the one after. Only a capture that has waited too long
+	//(like with smooth sun updates, where every frame is a commit frame) lands on one anyway.
+	const bool bNearCommit = LastSunCommitFrame != 0 && LastSunCommitFrame + 1 >= Frames.GetFrameNumber();
+	const bool bForced = PendingFrames >= MaxDeferFrames;
+
+	if (bForced || (!bNearCommit && Frames.GetLastFrameTime() <= Frames.GetMedianFrameTime()))
+	{
+		return true;
+	}
+
+	PendingFrames++;
+	return false;
+}
+
+void FSimpleDayNightSkyLightScheduler::NotifyRecaptured(uint64 Frame)
+{
+	bRecapturePending = false;
+	PendingFrames = 0;
+	CaptureFrame = Frame;
+	bMeasurePending = true;
+	Recaptures++;
+}
+
+void FSimpleDayNightSkyLightScheduler::Update(const FSimpleDayNightCommitScheduler& Frames, float BudgetMs, int32 MinResolution, int32 MaxResolution)
+{
+	if (!bMeasurePending || Frames.GetFrameNumber() <= CaptureFrame)
+	{
+		return;
+	}
+	bMeasurePending = false;
+
+	//Only the frame a capture lands on is ever compared, so the cost is how much slower it was than usual.
+	LastCaptureCostMs = FMath::Max(Frames.GetLastFrameTime() - Frames.GetMedianFrameTime(), 0.0f) * 1000.0f;
+
+	//Cost goes with the number of texels, so halving the resolution takes about three quarters off and doubling it quadruples it.
+	if (LastCaptureCostMs > BudgetMs && Resolution > MinResolution)
+	{
+		Resolution = FMath::Max(Resolution / 2, MinResolution);
+	}
+	else if (LastCaptureCostMs * 4.0f < BudgetMs && Resolution < MaxResolution)
+	{
+		Resolution = FMath::Min(Resolution * 2, MaxResolution);
+	}
+}
@@ -0,0 +1,131 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightSnapshot.h"
+
+FSimpleDayNightSnapshot FSimpleDayNightSnapshot::Make(const FSimpleDayNightTime& InTime, const FSimpleDayNightEphemerisParams& InParams, double InHoursPerSecond, double InWorldTime)
+{
+	FSimpleDayNightSnapshot Snapshot;
+	Snapshot.Time = InTime;
+	Snapshot.Params = InParams;
+	Snapshot.HoursPerSecond = InHoursPerSecond;
+	Snapshot.WorldTime = InWorldTime;
+	Snapshot.SeasonPhase = FSimpleDayNightEphemeris::GetSeasonPhase(InTime, InParams.SeasonLength);
+	Snapshot.SunDirection = FSimpleDayNightEphemeris::GetSunDirection(InTime, InParams);
+	Snapshot.SunElevation = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-Snapshot.SunDirection.Z, -1.0, 1.0)));
+	Snapshot.StarRotation = FSimpleDayNightEphemeris::GetStarRotation(InTime, InParams);
+	Snapshot.FrameNumber = GFrameCounter;
+	return Snapshot;
+}
+
+FSimpleDayNightSnapshot FSimpleDayNightSnapshot::EvaluateAt(const FSimpleDayNightTime& InTime) const
+{
+	const double Seconds = HoursPerSecond > 0.0 ? InTime.HoursSince(Time) / HoursPerSecond : 0.0;
+
+	FSimpleDayNightSnapshot Snapshot = Make(InTime, Params, HoursPerSecond, WorldTime + Seconds);
+	Snapshot.FrameNumber = FrameNumber;
+	return Snapshot;
+}
+
+FSimpleDayNightSnapshot FSimpleDayNightSnapshot::Predict(double Seconds) const
+{
+	FSimpleDayNightTime PredictedTime = Time;
+	PredictedTime.AddHours(Seconds * HoursPerSecond);
+
+	FSimpleDayNightSnapshot Snapshot = Make(PredictedTime, Params, HoursPerSecond, WorldTime + Seconds);
+	Snapshot.FrameNumber = FrameNumber;
+	return Snapshot;
+}
+
+void FSimpleDayNightSnapshotBuffer::Publish(const FSimpleDayNightSnapshot& Snapshot)
+{
+	//Write the slot readers aren't being pointed at, then point them at it.
+	const int32 Index = (Latest.load(std::memory_order_relaxed) + 1) & 1;
+	FSlot& Slot = Slots[Index];
+
+	const uint32 Sequence = Slot.Sequence.load(std::memory_order_relaxed);
+	Slot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Slot.Snapshot = Snapshot;
+
+	Slot.Sequence.store(Sequence + 2, std::memory_order_release);
+	Latest.store(Index, std::memory_order_release);
+}
+
+bool FSimpleDayNightSnapshotBuffer::Read(FSimpleDayNightSnapshot& OutSnapshot) const
+{
+	for (;;)
+	{
+		const int32 Index = Latest.load(std::memory_order_acquire);
+		if (Index == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const FSlot& Slot = Slots[Index];
+		const uint32 Sequence = Slot.Sequence.load(std::memory_order_acquire);
+		if (Sequence & 1)
+		{
+			//The writer lapped us and is rewriting this slot. The other one is complete.
+			continue;
+		}
+
+		OutSnapshot = Slot.Snapshot;
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (Slot.Sequence.load(std::memory_order_relaxed) == Sequence)
+		{
+			return true;
+		}
+	}
+}
+
+FSimpleDayNightSnapshotBuffer& FSimpleDayNightSnapshotBuffer::Get()
+{
+	static FSimpleDayNightSnapshotBuffer Buffer;
+	return Buffer;
+}
+
+//The only publisher allowed to write to Get(). Only touched on the game thread.
+static const void* GlobalPublisher = nullptr;
+
+bool FSimpleDayNightSnapshotBuffer::ClaimGlobal(const void* Publisher)
+{
+	check(IsInGameThread());
+
+	if (!GlobalPublisher)
+	{
+		GlobalPublisher = Publisher;
+	}
+	return GlobalPublisher == Publisher;
+}
+
+void FSimpleDayNightSnapshotBuffer::ReleaseGlobal(const void* Publisher)
+{
+	check(IsInGameThread());
+
+	if (GlobalPublisher == Publisher)
+	{
+		GlobalPublisher = nullptr;
+	}
+}
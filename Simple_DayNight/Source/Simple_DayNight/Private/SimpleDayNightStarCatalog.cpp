@@ -0,0 +1,313 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightStarCatalog.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+static float SignNotZero(float Value)
+{
+	return Value >= 0.0f ? 1.0f : -1.0f;
+}
+
+FSimpleDayNightStarCatalog::FSimpleDayNightStarCatalog() = default;
+
+FSimpleDayNightStarCatalog::~FSimpleDayNightStarCatalog()
+{
+	Reset();
+}
+
+bool FSimpleDayNightStarCatalog::ParseCsv(const FString& Csv, bool bRightAscensionInDegrees, TArray<FStar>& OutStars, FString& OutError)
+{
+	TArray<FString> Lines;
+	Csv.ParseIntoArrayLines(Lines);
+	if (Lines.Num() == 0)
+	{
+		OutError = TEXT("Empty catalog");
+		return false;
+	}
+
+	int32 RightAscensionColumn = 0;
+	int32 DeclinationColumn = 1;
+	int32 MagnitudeColumn = 2;
+	int32 ColorIndexColumn = 3;
+	int32 FirstLine = 0;
+
+	TArray<FString> Fields;
+	Lines[0].ParseIntoArray(Fields, TEXT(","), false);
+	if (Fields.Num() > 0 && !FCString::IsNumeric(*Fields[0].TrimStartAndEnd()))
+	{
+		RightAscensionColumn = DeclinationColumn = MagnitudeColumn = ColorIndexColumn = INDEX_NONE;
+		for (int32 Column = 0; Column < Fields.Num(); ++Column)
+		{
+			const FString Name = Fields[Column].TrimStartAndEnd().TrimQuotes().ToLower();
+			if (Name == TEXT("ra"))
+			{
+				RightAscensionColumn = Column;
+			}
+			else if (Name == TEXT("dec"))
+			{
+				DeclinationColumn = Column;
+			}
+			else if (Name == TEXT("mag") || Name == TEXT("vmag"))
+			{
+				MagnitudeColumn = Column;
+			}
+			else if (Name == TEXT("ci") || Name == TEXT("bv") || Name == TEXT("b-v"))
+			{
+				ColorIndexColumn = Column;
+			}
+		}
+
+		if (RightAscensionColumn == INDEX_NONE || DeclinationColumn == INDEX_NONE || MagnitudeColumn == INDEX_NONE)
+		{
+			OutError = TEXT("Header needs ra, dec and mag columns");
+			return false;
+		}
+		FirstLine = 1;
+	}
+
+	const int32 NeededColumns = FMath::Max3(RightAscensionColumn, DeclinationColumn, MagnitudeColumn) + 1;
+	OutStars.Reserve(OutStars.Num() + Lines.Num() - FirstLine);
+
+	for (int32 Line = FirstLine; Line < Lines.Num(); ++Line)
+	{
+		Lines[Line].ParseIntoArray(Fields, TEXT(","), false);
+		if (Fields.Num() < NeededColumns)
+		{
+			continue;
+		}
+
+		const FString RightAscension = Fields[RightAscensionColumn].TrimStartAndEnd();
+		const FString Declination = Fields[DeclinationColumn].TrimStartAndEnd();
+		const FString Magnitude = Fields[MagnitudeColumn].TrimStartAndEnd();
+		if (RightAscension.IsEmpty() || Declination.IsEmpty() || Magnitude.IsEmpty() ||
+			!FCString::IsNumeric(*RightAscension) || !FCString::IsNumeric(*Declination) || !FCString::IsNumeric(*Magnitude))
+		{
+			continue;
+		}
+
+		FStar& Star = OutStars.AddDefaulted_GetRef();
+		Star.Direction = GetDirection(FCString::Atod(*RightAscension) * (bRightAscensionInDegrees ? 1.0 : 15.0), FCString::Atod(*Declination));
+		Star.Magnitude = FCString::Atof(*Magnitude);
+
+		//Plenty of stars have no measured color, they're drawn white.
+		if (Fields.IsValidIndex(ColorIndexColumn))
+		{
+			const FString ColorIndex = Fields[ColorIndexColumn].TrimStartAndEnd();
+			if (!ColorIndex.IsEmpty() && FCString::IsNumeric(*ColorIndex))
+			{
+				Star.ColorIndex = FCString::Atof(*ColorIndex);
+			}
+		}
+	}
+
+	return true;
+}
+
+FVector3f FSimpleDayNightStarCatalog::GetDirection(double RightAscension, double Declination)
+{
+	double SinRA, CosRA, SinDec, CosDec;
+	FMath::SinCos(&SinRA, &CosRA, FMath::DegreesToRadians(RightAscension));
+	FMath::SinCos(&SinDec, &CosDec, FMath::DegreesToRadians(Declination));
+	return FVector3f((float)(CosDec * CosRA), (float)(CosDec * SinRA), (float)SinDec);
+}
+
+void FSimpleDayNightStarCatalog::Write(TArray<FStar> Stars, TArray<uint8>& OutBytes)
+{
+	Stars.StableSort([](const FStar& A, const FStar& B) { return A.Magnitude < B.Magnitude; });
+
+	OutBytes.SetNumZeroed(sizeof(FHeader) + Stars.Num() * sizeof(FRecord));
+
+	FHeader& Header = *(FHeader*)OutBytes.GetData();
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.RecordSize = sizeof(FRecord);
+	Header.NumStars = Stars.Num();
+
+	FRecord* OutRecords = (FRecord*)(OutBytes.GetData() + sizeof(FHeader));
+	for (int32 Index = 0; Index < Stars.Num(); ++Index)
+	{
+		const FStar& Star = Stars[Index];
+		FRecord& Record = OutRecords[Index];
+
+		//Octahedral encoding: project onto the octahedron, fold the lower half over the upper, and quantize the two coordinates.
+		const FVector3f Direction = Star.Direction.GetSafeNormal();
+		const float L1 = FMath::Abs(Direction.X) + FMath::Abs(Direction.Y) + FMath::Abs(Direction.Z);
+		float X = L1 > 0.0f ? Direction.X / L1 : 0.0f;
+		float Y = L1 > 0.0f ? Direction.Y / L1 : 0.0f;
+		if (Direction.Z < 0.0f)
+		{
+			const float FoldedX = (1.0f - FMath::Abs(Y)) * SignNotZero(X);
+			Y = (1.0f - FMath::Abs(X)) * SignNotZero(Y);
+			X = FoldedX;
+		}
+
+		Record.DirectionX = (int16)FMath::RoundToInt(FMath::Clamp(X, -1.0f, 1.0f) * MAX_int16);
+		Record.DirectionY = (int16)FMath::RoundToInt(FMath::Clamp(Y, -1.0f, 1.0f) * MAX_int16);
+		Record.Magnitude = (int16)FMath::Clamp(FMath::RoundToInt(Star.Magnitude * 1000.0f), (int32)MIN_int16, (int32)MAX_int16);
+		Record.ColorIndex = (int8)FMath::Clamp(FMath::RoundToInt(Star.ColorIndex * 40.0f), (int32)MIN_int8, (int32)MAX_int8);
+	}
+}
+
+bool FSimpleDayNightStarCatalog::Load(const FString& Filename)
+{
+	Reset();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (MappedFile.IsValid() && MappedFile->GetFileSize() > 0)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if (MappedRegion.IsValid())
+		{
+			if (Attach(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()))
+			{
+				return true;
+			}
+
+			Reset();
+			return false;
+		}
+	}
+	MappedFile.Reset();
+
+	TArray<uint8> FileBytes;
+	return FFileHelper::LoadFileToArray(FileBytes, *Filename, FILEREAD_Silent) && LoadFromMemory(MoveTemp(FileBytes));
+}
+
+bool FSimpleDayNightStarCatalog::LoadFromMemory(TArray<uint8>&& InBytes)
+{
+	Reset();
+
+	Bytes = MoveTemp(InBytes);
+	if (!Attach(Bytes.GetData(), Bytes.Num()))
+	{
+		Reset();
+		return false;
+	}
+	return true;
+}
+
+void FSimpleDayNightStarCatalog::Reset()
+{
+	Records = nullptr;
+	NumStars = 0;
+
+	//The region has to go before the file it maps.
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Bytes.Empty();
+}
+
+bool FSimpleDayNightStarCatalog::Attach(const uint8* Data, int64 Size)
+{
+	if (!Data || Size < (int64)sizeof(FHeader))
+	{
+		return false;
+	}
+
+	const FHeader& Header = *(const FHeader*)Data;
+	if (Header.Magic != Magic || Header.Version != Version || Header.RecordSize != sizeof(FRecord) ||
+		Header.NumStars > (uint32)MAX_int32 || Size < (int64)sizeof(FHeader) + (int64)Header.NumStars * (int64)sizeof(FRecord))
+	{
+		return false;
+	}
+
+	Records = (const FRecord*)(Data + sizeof(FHeader));
+	NumStars = (int32)Header.NumStars;
+	return true;
+}
+
+FVector3f FSimpleDayNightStarCatalog::DecodeDirection(const FRecord& Record)
+{
+	float X = Record.DirectionX / (float)MAX_int16;
+	float Y = Record.DirectionY / (float)MAX_int16;
+	const float Z = 1.0f - FMath::Abs(X) - FMath::Abs(Y);
+	if (Z < 0.0f)
+	{
+		const float UnfoldedX = (1.0f - FMath::Abs(Y)) * SignNotZero(X);
+		Y = (1.0f - FMath::Abs(X)) * SignNotZero(Y);
+		X = UnfoldedX;
+	}
+	return FVector3f(X, Y, Z).GetUnsafeNormal();
+}
+
+FSimpleDayNightStarCatalog::FStar FSimpleDayNightStarCatalog::GetStar(int32 Index) const
+{
+	check(Index >= 0 && Index < NumStars);
+	const FRecord& Record = Records[Index];
+
+	FStar Star;
+	Star.Direction = DecodeDirection(Record);
+	Star.Magnitude = Record.Magnitude / 1000.0f;
+	Star.ColorIndex = Record.ColorIndex / 40.0f;
+	return Star;
+}
+
+int32 FSimpleDayNightStarCatalog::GetNumBrighterThan(float MagnitudeLimit) const
+{
+	const int32 Limit = FMath::Clamp(FMath::RoundToInt(MagnitudeLimit * 1000.0f), (int32)MIN_int16, (int32)MAX_int16);
+
+	//Brightest first, so find the first record past the limit.
+	int32 Low = 0;
+	int32 High = NumStars;
+	while (Low < High)
+	{
+		const int32 Middle = Low + (High - Low) / 2;
+		if (Records[Middle].Magnitude <= Limit)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+	return Low;
+}
+
+void FSimpleDayNightStarCatalog::Cull(float MagnitudeLimit, const FVector3f& ViewDirection, float CosHalfAngle, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	const int32 NumBright = GetNumBrighterThan(MagnitudeLimit);
+	if (ViewDirection.IsZero())
+	{
+		OutIndices.SetNumUninitialized(NumBright);
+		for (int32 Index = 0; Index < NumBright; ++Index)
+		{
+			OutIndices[Index] = Index;
+		}
+		return;
+	}
+
+	const FVector3f View = ViewDirection.GetSafeNormal();
+	for (int32 Index = 0; Index < NumBright; ++Index)
+	{
+		if ((DecodeDirection(Records[Index]) | View) >= CosHalfAngle)
+		{
+			OutIndices.Add(Index);
+		}
+	}
+}
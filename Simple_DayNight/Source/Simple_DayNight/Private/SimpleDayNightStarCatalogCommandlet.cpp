@@ -0,0 +1,87 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightStarCatalogCommandlet.h"
+#include "SimpleDayNightStarCatalog.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+USimpleDayNightStarCatalogCommandlet::USimpleDayNightStarCatalogCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USimpleDayNightStarCatalogCommandlet::Main(const FString& Params)
+{
+	FString InputPath;
+	if (!FParse::Value(*Params, TEXT("Input="), InputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimpleDayNight star catalog: -Input=<csv> is required"));
+		return 1;
+	}
+
+	FString OutputPath = FPaths::ProjectContentDir() / TEXT("SimpleDayNight") / TEXT("Stars.sdnstars");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	float MagnitudeLimit = 8.0f;
+	FParse::Value(*Params, TEXT("MagnitudeLimit="), MagnitudeLimit);
+
+	float BrightestMagnitude = -2.0f;
+	FParse::Value(*Params, TEXT("BrightestMagnitude="), BrightestMagnitude);
+
+	FString Csv;
+	if (!FFileHelper::LoadFileToString(Csv, *InputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimpleDayNight star catalog: couldn't read %s"), *InputPath);
+		return 1;
+	}
+
+	TArray<FSimpleDayNightStarCatalog::FStar> Stars;
+	FString Error;
+	if (!FSimpleDayNightStarCatalog::ParseCsv(Csv, FParse::Param(*Params, TEXT("RADegrees")), Stars, Error))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimpleDayNight star catalog: %s: %s"), *InputPath, *Error);
+		return 1;
+	}
+
+	const int32 NumParsed = Stars.Num();
+	Stars.RemoveAllSwap([MagnitudeLimit, BrightestMagnitude](const FSimpleDayNightStarCatalog::FStar& Star)
+	{
+		return Star.Magnitude > MagnitudeLimit || Star.Magnitude < BrightestMagnitude;
+	});
+
+	const int32 NumKept = Stars.Num();
+	TArray<uint8> Bytes;
+	FSimpleDayNightStarCatalog::Write(MoveTemp(Stars), Bytes);
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *OutputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SimpleDayNight star catalog: couldn't write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("SimpleDayNight star catalog: %d of %d stars written to %s (%d bytes)"), NumKept, NumParsed, *OutputPath, Bytes.Num());
+	return 0;
+}
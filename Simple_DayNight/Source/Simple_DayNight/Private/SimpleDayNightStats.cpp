@@ -0,0 +1,43 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightStats.h"
+
+DEFINE_STAT(STAT_SimpleDayNight_ControllerTick);
+DEFINE_STAT(STAT_SimpleDayNight_Advance);
+DEFINE_STAT(STAT_SimpleDayNight_UpdateSunPosition);
+DEFINE_STAT(STAT_SimpleDayNight_UpdateStarPosition);
+DEFINE_STAT(STAT_SimpleDayNight_CVarChanged);
+DEFINE_STAT(STAT_SimpleDayNight_SkyLightRecapture);
+DEFINE_STAT(STAT_SimpleDayNight_UpdateSkyBodies);
+DEFINE_STAT(STAT_SimpleDayNight_StarFieldRebuild);
+
+DEFINE_STAT(STAT_SimpleDayNight_SunCommits);
+DEFINE_STAT(STAT_SimpleDayNight_SkippedSunCommits);
+DEFINE_STAT(STAT_SimpleDayNight_TransformChanges);
+DEFINE_STAT(STAT_SimpleDayNight_SkyLightRecaptures);
+
+DEFINE_STAT(STAT_SimpleDayNight_SunCommitsPerSecond);
+DEFINE_STAT(STAT_SimpleDayNight_SunStep);
+DEFINE_STAT(STAT_SimpleDayNight_TicksPerSecond);
+
+CSV_DEFINE_CATEGORY(SimpleDayNight, true);
@@ -0,0 +1,678 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightSubsystem.h"
+#include "DayNightController.h"
+#include "SimpleDayNightLatitudeVolume.h"
+#include "Components/BrushComponent.h"
+#include "Engine/World.h"
+#include "SimpleDayNightStats.h"
+
+//Size of the cells of the region grid in world units (1km), and the most cells a region may cover before it's checked everywhere instead
+static constexpr double RegionCellSize = 100000.0;
+static constexpr int64 MaxRegionCells = 4096;
+
+//Seconds of world time the timeline keeps behind the current time, for rollback and for sampling the recent past
+static constexpr double TimelineHistorySeconds = 60.0;
+
+void USimpleDayNightSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	//Start from the project's settings, so the clock runs the same with or without a controller in the level.
+	const ADayNightController* Defaults = GetDefault<ADayNightController>();
+	Clock = FSimpleDayNightTime::FromHours(Defaults->TimeOfDay);
+	Params = Defaults->GetEphemerisParams();
+	LengthOfDay = Defaults->LengthOfDay;
+	SetTickInterval(Defaults->ClockTickInterval);
+	Timeline.Reset(0, FSimpleDayNightTimeline::ToClockTicks(Clock), GetRate());
+
+	//OnCelestialEvent fires for every event type with no offset.
+	for (ECelestialEvent Event : TEnumRange<ECelestialEvent>())
+	{
+		EventScheduler.Register(Event, 0.0, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateUObject(this, &USimpleDayNightSubsystem::BroadcastCelestialEvent));
+	}
+}
+
+void USimpleDayNightSubsystem::Deinitialize()
+{
+	Presenters.Reset();
+	BoundCelestialEvents.Reset();
+	Regions.Empty();
+	RegionGrid.Empty();
+	LargeRegions.Empty();
+	FSimpleDayNightSnapshotBuffer::ReleaseGlobal(this);
+
+	Super::Deinitialize();
+}
+
+void USimpleDayNightSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	LastAdvanceWorldTime = InWorld.GetTimeSeconds();
+
+	//Nothing moved before play, so start the timeline from wherever the clock was left.
+	Timeline.Reset(GetWorldTick(), FSimpleDayNightTimeline::ToClockTicks(Clock), GetRate());
+}
+
+void USimpleDayNightSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Advance();
+}
+
+TStatId USimpleDayNightSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USimpleDayNightSubsystem, STATGROUP_Tickables);
+}
+
+void USimpleDayNightSubsystem::Advance()
+{
+	const UWorld* World = GetWorld();
+	if (LastAdvanceFrame == GFrameCounter || !World || !World->HasBegunPlay())
+	{
+		return;
+	}
+	LastAdvanceFrame = GFrameCounter;
+
+	//Warps always update, so they land on time.
+	if (!bWarping && World->GetTimeSeconds() - LastAdvanceWorldTime < TickInterval)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SimpleDayNight_Advance);
+	TRACE_CPUPROFILER_EVENT_SCOPE(USimpleDayNightSubsystem::Advance);
+	CSV_SCOPED_TIMING_STAT(SimpleDayNight, ClockAdvance);
+
+	Rebase();
+	Timeline.TrimBefore(FSimpleDayNightTimeline::ToWorldTicks(LastAdvanceWorldTime - TimelineHistorySeconds));
+
+	if (bWarping && LastAdvanceWorldTime >= WarpEndWorldTime)
+	{
+		FinishWarp();
+		return;
+	}
+
+	//Events fire on dedicated servers too, they need them most.
+	EventScheduler.AdvanceTo(Clock, Params);
+
+	UpdateRegions();
+	PublishSnapshot();
+}
+
+FSimpleDayNightTime USimpleDayNightSubsystem::GetTime() const
+{
+	return EvaluateClock(GetWorldTime());
+}
+
+FSimpleDayNightTime USimpleDayNightSubsystem::EvaluateClock(double WorldTime) const
+{
+	return Timeline.SampleTime(FSimpleDayNightTimeline::ToWorldTicks(WorldTime));
+}
+
+double USimpleDayNightSubsystem::GetCurrentHoursPerSecond() const
+{
+	return FSimpleDayNightTimeline::ToHoursPerSecond(Timeline.GetSegment(GetWorldTick()).Rate);
+}
+
+void USimpleDayNightSubsystem::SetTime(const FSimpleDayNightTime& Time)
+{
+	Rebase();
+	EndWarp();
+	Timeline.AddSegment(GetWorldTick(), FSimpleDayNightTimeline::ToClockTicks(Time), GetRate());
+	Clock = EvaluateClock(LastAdvanceWorldTime);
+	ClockGeneration++;
+
+	OnClockChanged.Broadcast();
+}
+
+FSimpleDayNightClockState USimpleDayNightSubsystem::SaveClockState() const
+{
+	FSimpleDayNightClockState State;
+	State.Timeline = Timeline.Snapshot(GetWorldTick());
+	State.LengthOfDay = LengthOfDay;
+	State.bWarping = bWarping;
+	State.bCollapseWarpEvents = IsCollapsingWarpEvents();
+	State.WarpStart = WarpStart;
+	State.WarpTarget = WarpTarget;
+	State.WarpStartWorldTime = WarpStartWorldTime;
+	State.WarpEndWorldTime = WarpEndWorldTime;
+	return State;
+}
+
+void USimpleDayNightSubsystem::RestoreClockState(const FSimpleDayNightClockState& State)
+{
+	if (!State.IsValid())
+	{
+		return;
+	}
+
+	EndWarp();
+	LengthOfDay = State.LengthOfDay;
+	Timeline.Restore(State.Timeline);
+	Rebase();
+
+	//The warp's segments came back with the timeline, only the state around them needs putting back.
+	if (State.bWarping && LastAdvanceWorldTime < State.WarpEndWorldTime)
+	{
+		WarpStart = State.WarpStart;
+		BeginWarp(State.WarpTarget, State.bCollapseWarpEvents);
+		WarpStartWorldTime = State.WarpStartWorldTime;
+		WarpEndWorldTime = State.WarpEndWorldTime;
+		WarpCount++;
+	}
+	ClockGeneration++;
+
+	//Going back in time reschedules the events rather than firing them again.
+	EventScheduler.AdvanceTo(Clock, Params);
+	UpdateRegions();
+	PublishSnapshot();
+
+	OnClockChanged.Broadcast();
+}
+
+void USimpleDayNightSubsystem::WarpTo(const FSimpleDayNightTime& Target, float Duration, bool bCollapseEvents)
+{
+	//Fire everything up to now first, so the warp only covers the time it skips.
+	Rebase();
+	EventScheduler.AdvanceTo(Clock, Params);
+	EndWarp();
+
+	WarpStart = Clock;
+	BeginWarp(Target, bCollapseEvents);
+	WarpCount++;
+	ClockGeneration++;
+
+	const int64 StartTick = FSimpleDayNightTimeline::ToWorldTicks(LastAdvanceWorldTime);
+	const int64 TargetTicks = FSimpleDayNightTimeline::ToClockTicks(Target);
+
+	//Nothing moves before play starts, so a timed warp would never land.
+	const UWorld* World = GetWorld();
+	if (Duration > 0.0f && World && World->HasBegunPlay())
+	{
+		//Straight there, then on at the normal rate from exactly the target, whatever rounding the warp's rate had.
+		WarpEndWorldTime = LastAdvanceWorldTime + Duration;
+		const int64 EndTick = FSimpleDayNightTimeline::ToWorldTicks(WarpEndWorldTime);
+		const int64 StartTicks = FSimpleDayNightTimeline::ToClockTicks(Clock);
+		Timeline.AddSegment(StartTick, StartTicks, FSimpleDayNightTimeline::GetRateToCover(TargetTicks - StartTicks, EndTick - StartTick));
+		Timeline.AddSegment(EndTick, TargetTicks, GetRate());
+
+		PublishSnapshot();
+		OnWarp.Broadcast(false);
+		return;
+	}
+
+	Timeline.AddSegment(StartTick, TargetTicks, GetRate());
+	Clock = EvaluateClock(LastAdvanceWorldTime);
+	FinishWarp();
+}
+
+void USimpleDayNightSubsystem::BeginWarp(const FSimpleDayNightTime& Target, bool bCollapseEvents)
+{
+	bWarping = true;
+	WarpTarget = Target;
+	WarpStartWorldTime = LastAdvanceWorldTime;
+	WarpEndWorldTime = LastAdvanceWorldTime;
+
+	//Let the event scheduler walk the whole warp instead of treating it as a jump, even if a frame covers days of it.
+	SavedMaxCatchUpHours = EventScheduler.GetMaxCatchUpHours();
+	EventScheduler.SetMaxCatchUpHours(FMath::Max(SavedMaxCatchUpHours, Target.HoursSince(Clock) + 1.0));
+	if (bCollapseEvents)
+	{
+		EventScheduler.BeginCollapse();
+	}
+}
+
+void USimpleDayNightSubsystem::FinishWarp()
+{
+	EventScheduler.AdvanceTo(Clock, Params);
+	EndWarp();
+	UpdateRegions();
+	PublishSnapshot();
+
+	OnWarp.Broadcast(true);
+	OnWarpFinished.Broadcast();
+}
+
+void USimpleDayNightSubsystem::EndWarp()
+{
+	if (!bWarping)
+	{
+		return;
+	}
+	bWarping = false;
+
+	EventScheduler.SetMaxCatchUpHours(SavedMaxCatchUpHours);
+	EventScheduler.EndCollapse();
+}
+
+void USimpleDayNightSubsystem::CorrectClock(double ErrorHours, float CorrectionTime)
+{
+	//One slew per update instead of a nudge every frame, so the segments and the result don't depend on the frame rate.
+	Timeline.Slew(GetWorldTick(), FMath::RoundToInt64(ErrorHours * FSimpleDayNightTimeline::ClockTicksPerHour), FSimpleDayNightTimeline::ToWorldTicks(CorrectionTime), GetRate());
+
+	//The clock is sampled at the same world tick the correction starts at.
+	Rebase();
+}
+
+void USimpleDayNightSubsystem::SetLengthOfDay(float InLengthOfDay)
+{
+	if (LengthOfDay == InLengthOfDay)
+	{
+		return;
+	}
+	LengthOfDay = InLengthOfDay;
+
+	//A running warp keeps its own rate, the new one takes over when it lands.
+	const int64 WorldTick = GetWorldTick();
+	if (bWarping && WorldTick < FSimpleDayNightTimeline::ToWorldTicks(WarpEndWorldTime))
+	{
+		Timeline.AddSegment(FSimpleDayNightTimeline::ToWorldTicks(WarpEndWorldTime), FSimpleDayNightTimeline::ToClockTicks(WarpTarget), GetRate());
+	}
+	else
+	{
+		Timeline.SetRate(WorldTick, GetRate());
+	}
+
+	OnClockChanged.Broadcast();
+}
+
+void USimpleDayNightSubsystem::SetEphemerisParams(const FSimpleDayNightEphemerisParams& InParams)
+{
+	//The event scheduler notices the change and reschedules on the next update.
+	Params = InParams;
+
+	OnClockChanged.Broadcast();
+}
+
+double USimpleDayNightSubsystem::GetTimeOfDay() const
+{
+	return GetTime().ToHours();
+}
+
+void USimpleDayNightSubsystem::SetTimeOfDay(double InTimeOfDay)
+{
+	SetTime(FSimpleDayNightTime::FromHours(InTimeOfDay));
+}
+
+void USimpleDayNightSubsystem::WarpToTimeOfDay(double InTimeOfDay, float Duration, bool bCollapseEvents)
+{
+	WarpTo(FSimpleDayNightTime::FromHours(InTimeOfDay), Duration, bCollapseEvents);
+}
+
+void USimpleDayNightSubsystem::WarpForward(double Hours, float Duration, bool bCollapseEvents)
+{
+	FSimpleDayNightTime Target = GetTime();
+	Target.AddHours(Hours);
+	WarpTo(Target, Duration, bCollapseEvents);
+}
+
+bool USimpleDayNightSubsystem::WarpToCelestialEvent(ECelestialEvent Event, float OffsetHours, float Duration, bool bCollapseEvents)
+{
+	//Search from OffsetHours back, so the event itself may already have passed as long as the offset time hasn't.
+	FSimpleDayNightTime After = GetTime();
+	After.AddHours(-OffsetHours);
+
+	FSimpleDayNightTime Target;
+	if (!FSimpleDayNightEventScheduler::FindNextEvent(Event, After, Params, Target))
+	{
+		return false;
+	}
+	Target.AddHours(OffsetHours);
+
+	WarpTo(Target, Duration, bCollapseEvents);
+	return true;
+}
+
+FVector USimpleDayNightSubsystem::GetSunDirection() const
+{
+	return FSimpleDayNightEphemeris::GetSunDirection(GetTime(), Params);
+}
+
+double USimpleDayNightSubsystem::GetSunElevation() const
+{
+	return FSimpleDayNightEphemeris::GetSunElevation(GetTime(), Params);
+}
+
+void USimpleDayNightSubsystem::Rebase()
+{
+	const double WorldTime = GetWorldTime();
+	Clock = EvaluateClock(WorldTime);
+	LastAdvanceWorldTime = WorldTime;
+}
+
+double USimpleDayNightSubsystem::GetWorldTime() const
+{
+	//Nothing moves before play starts, editor worlds included.
+	const UWorld* World = GetWorld();
+	return World && World->HasBegunPlay() ? World->GetTimeSeconds() : LastAdvanceWorldTime;
+}
+
+void USimpleDayNightSubsystem::PublishSnapshot()
+{
+	const FSimpleDayNightSnapshot Snapshot = FSimpleDayNightSnapshot::Make(Clock, Params, GetCurrentHoursPerSecond(), LastAdvanceWorldTime);
+
+	SnapshotBuffer.Publish(Snapshot);
+
+	//The first game world to publish keeps the global buffer until it goes away, it's single writer.
+	if (GetWorld()->IsGameWorld() && FSimpleDayNightSnapshotBuffer::ClaimGlobal(this))
+	{
+		FSimpleDayNightSnapshotBuffer::Get().Publish(Snapshot);
+	}
+}
+
+FIntPoint USimpleDayNightSubsystem::GetRegionCell(const FVector& WorldPosition)
+{
+	return FIntPoint((int32)FMath::FloorToDouble(WorldPosition.X / RegionCellSize), (int32)FMath::FloorToDouble(WorldPosition.Y / RegionCellSize));
+}
+
+void USimpleDayNightSubsystem::RegisterRegion(ASimpleDayNightLatitudeVolume* Volume)
+{
+	FLatitudeRegion Region;
+	Region.Volume = Volume;
+	Region.Bounds = Volume->GetBrushComponent() ? Volume->GetBrushComponent()->Bounds.GetBox() : Volume->GetComponentsBoundingBox();
+	Region.Area = Region.Bounds.GetSize().X * Region.Bounds.GetSize().Y;
+	Region.BlendDistance = Volume->BlendDistance;
+	Region.Params = Params;
+	Region.Params.Latitude = Volume->Latitude;
+	Region.bCached = GetDefault<ADayNightController>()->OrientationCacheKeys > 0;
+	Region.Cache.SetKeysPerDay(GetDefault<ADayNightController>()->OrientationCacheKeys);
+	Region.SunDirection = FSimpleDayNightEphemeris::GetSunDirection(Clock, Region.Params);
+
+	const int32 Index = Regions.Add(MoveTemp(Region));
+	const FBox& Bounds = Regions[Index].Bounds;
+
+	const FIntPoint MinCell = GetRegionCell(Bounds.Min);
+	const FIntPoint MaxCell = GetRegionCell(Bounds.Max);
+	if ((int64)(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) > MaxRegionCells)
+	{
+		LargeRegions.Add(Index);
+	}
+	else
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				RegionGrid.FindOrAdd(FIntPoint(X, Y)).Add(Index);
+			}
+		}
+	}
+
+	BaseSunDirection = FSimpleDayNightEphemeris::GetSunDirection(Clock, Params);
+}
+
+void USimpleDayNightSubsystem::UnregisterRegion(ASimpleDayNightLatitudeVolume* Volume)
+{
+	for (TSparseArray<FLatitudeRegion>::TIterator It(Regions); It; ++It)
+	{
+		if (It->Volume == Volume)
+		{
+			const int32 Index = It.GetIndex();
+			LargeRegions.Remove(Index);
+			for (auto GridIt = RegionGrid.CreateIterator(); GridIt; ++GridIt)
+			{
+				GridIt->Value.Remove(Index);
+				if (GridIt->Value.Num() == 0)
+				{
+					GridIt.RemoveCurrent();
+				}
+			}
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void USimpleDayNightSubsystem::UpdateRegions()
+{
+	if (Regions.Num() == 0)
+	{
+		return;
+	}
+
+	BaseSunDirection = FSimpleDayNightEphemeris::GetSunDirection(Clock, Params);
+
+	for (FLatitudeRegion& Region : Regions)
+	{
+		//Only the latitude is the region's own.
+		Region.Params.AxialTilt = Params.AxialTilt;
+		Region.Params.SeasonLength = Params.SeasonLength;
+		Region.SunDirection = FSimpleDayNightEphemeris::GetSunDirection(Clock, Region.Params);
+
+		if (Region.bCached)
+		{
+			Region.Cache.Prefetch(2);
+		}
+	}
+}
+
+float USimpleDayNightSubsystem::GetRegionWeights(const FVector& WorldPosition, FRegionWeights& OutWeights) const
+{
+	auto Consider = [this, &WorldPosition, &OutWeights](int32 Index)
+	{
+		const FLatitudeRegion& Region = Regions[Index];
+		if (!Region.Bounds.IsInsideOrOn(WorldPosition))
+		{
+			return;
+		}
+
+		//Blend on distance to the nearest side, not the top or bottom, so latitude changes across the map and not with altitude.
+		const FVector& Min = Region.Bounds.Min;
+		const FVector& Max = Region.Bounds.Max;
+		const double Inside = FMath::Min(FMath::Min(WorldPosition.X - Min.X, Max.X - WorldPosition.X), FMath::Min(WorldPosition.Y - Min.Y, Max.Y - WorldPosition.Y));
+		const float Weight = Region.BlendDistance > 0.0f ? (float)FMath::Clamp(Inside / Region.BlendDistance, 0.0, 1.0) : 1.0f;
+
+		if (Weight > 0.0f)
+		{
+			OutWeights.Emplace(Index, Weight);
+		}
+	};
+
+	if (const TArray<int32>* CellRegions = RegionGrid.Find(GetRegionCell(WorldPosition)))
+	{
+		for (const int32 Index : *CellRegions)
+		{
+			Consider(Index);
+		}
+	}
+	for (const int32 Index : LargeRegions)
+	{
+		Consider(Index);
+	}
+
+	//Smallest first, each covering its share of whatever the ones before it left.
+	OutWeights.Sort([this](const TPair<int32, float>& A, const TPair<int32, float>& B) { return Regions[A.Key].Area < Regions[B.Key].Area; });
+
+	float Remaining = 1.0f;
+	for (TPair<int32, float>& Weight : OutWeights)
+	{
+		Weight.Value *= Remaining;
+		Remaining -= Weight.Value;
+	}
+	return Remaining;
+}
+
+FVector USimpleDayNightSubsystem::GetSunDirectionAt(const FVector& WorldPosition) const
+{
+	if (Regions.Num() == 0)
+	{
+		return GetSunDirection();
+	}
+
+	FRegionWeights Weights;
+	FVector Direction = BaseSunDirection * GetRegionWeights(WorldPosition, Weights);
+	for (const TPair<int32, float>& Weight : Weights)
+	{
+		Direction += Regions[Weight.Key].SunDirection * Weight.Value;
+	}
+	return Direction.GetSafeNormal();
+}
+
+double USimpleDayNightSubsystem::GetSunElevationAt(const FVector& WorldPosition) const
+{
+	return FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-GetSunDirectionAt(WorldPosition).Z, -1.0, 1.0)));
+}
+
+float USimpleDayNightSubsystem::GetLatitudeAt(const FVector& WorldPosition) const
+{
+	FRegionWeights Weights;
+	double Latitude = Params.Latitude * GetRegionWeights(WorldPosition, Weights);
+	for (const TPair<int32, float>& Weight : Weights)
+	{
+		Latitude += Regions[Weight.Key].Params.Latitude * Weight.Value;
+	}
+	return (float)Latitude;
+}
+
+FVector USimpleDayNightSubsystem::EvaluateSunDirectionAt(const FVector& WorldPosition, const FSimpleDayNightTime& Time) const
+{
+	FRegionWeights Weights;
+	const float BaseWeight = GetRegionWeights(WorldPosition, Weights);
+
+	FVector Direction = BaseWeight > 0.0f ? FSimpleDayNightEphemeris::GetSunDirection(Time, Params) * BaseWeight : FVector::ZeroVector;
+	for (const TPair<int32, float>& Weight : Weights)
+	{
+		Direction += FSimpleDayNightEphemeris::GetSunDirection(Time, Regions[Weight.Key].Params) * Weight.Value;
+	}
+	return Direction.GetSafeNormal();
+}
+
+void USimpleDayNightSubsystem::BlendRegionOrientation(const FVector& WorldPosition, const FSimpleDayNightTime& Time, FSimpleDayNightOrientation& InOutOrientation)
+{
+	FRegionWeights Weights;
+	const float BaseWeight = GetRegionWeights(WorldPosition, Weights);
+	if (Weights.Num() == 0)
+	{
+		return;
+	}
+
+	//Weighted sums of the quaternions, each flipped onto the same side as the sum so far, then normalized.
+	auto AddQuat = [](FQuat& Sum, const FQuat& Quat, float Weight)
+	{
+		Sum += Quat * (double)((Sum | Quat) < 0.0 ? -Weight : Weight);
+	};
+
+	FSimpleDayNightOrientation Blended;
+	Blended.Axis = InOutOrientation.Axis * (double)BaseWeight;
+	Blended.SunRelative = InOutOrientation.SunRelative * (double)BaseWeight;
+	Blended.Stars = InOutOrientation.Stars * (double)BaseWeight;
+	Blended.SunDirection = InOutOrientation.SunDirection * BaseWeight;
+
+	for (const TPair<int32, float>& Weight : Weights)
+	{
+		FLatitudeRegion& Region = Regions[Weight.Key];
+		const FSimpleDayNightOrientation Sample = Region.bCached ? Region.Cache.Sample(Time, Region.Params) : FSimpleDayNightEphemeris::Evaluate(Time, Region.Params);
+
+		AddQuat(Blended.Axis, Sample.Axis, Weight.Value);
+		AddQuat(Blended.SunRelative, Sample.SunRelative, Weight.Value);
+		AddQuat(Blended.Stars, Sample.Stars, Weight.Value);
+		Blended.SunDirection += Sample.SunDirection * Weight.Value;
+	}
+
+	Blended.Axis.Normalize();
+	Blended.SunRelative.Normalize();
+	Blended.Stars.Normalize();
+	Blended.SunDirection = Blended.SunDirection.GetSafeNormal();
+	Blended.SunElevation = FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(-Blended.SunDirection.Z, -1.0, 1.0)));
+
+	InOutOrientation = Blended;
+}
+
+void USimpleDayNightSubsystem::BroadcastCelestialEvent(ECelestialEvent Event, double OffsetHours)
+{
+	OnCelestialEvent.Broadcast(Event, (float)OffsetHours);
+}
+
+void USimpleDayNightSubsystem::BindCelestialEvent(ECelestialEvent Event, float OffsetHours, FCelestialEventDelegate Delegate)
+{
+	const FDelegateHandle Handle = EventScheduler.Register(Event, OffsetHours, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateWeakLambda(this,
+		[Delegate](ECelestialEvent InEvent, double InOffsetHours)
+		{
+			Delegate.ExecuteIfBound(InEvent, (float)InOffsetHours);
+		}));
+
+	BoundCelestialEvents.Emplace(Delegate, Handle);
+}
+
+void USimpleDayNightSubsystem::UnbindCelestialEvent(FCelestialEventDelegate Delegate)
+{
+	for (int32 Index = BoundCelestialEvents.Num() - 1; Index >= 0; --Index)
+	{
+		if (BoundCelestialEvents[Index].Key == Delegate)
+		{
+			EventScheduler.Unregister(BoundCelestialEvents[Index].Value);
+			BoundCelestialEvents.RemoveAtSwap(Index);
+		}
+	}
+}
+
+double USimpleDayNightSubsystem::GetHoursUntilCelestialEvent(ECelestialEvent Event) const
+{
+	const FSimpleDayNightTime Time = GetTime();
+
+	FSimpleDayNightTime EventTime;
+	if (FSimpleDayNightEventScheduler::FindNextEvent(Event, Time, Params, EventTime))
+	{
+		return EventTime.HoursSince(Time);
+	}
+	return -1.0;
+}
+
+ADayNightController* USimpleDayNightSubsystem::GetPrimaryController() const
+{
+	for (const TWeakObjectPtr<ADayNightController>& Presenter : Presenters)
+	{
+		if (ADayNightController* Controller = Presenter.Get())
+		{
+			return Controller;
+		}
+	}
+	return nullptr;
+}
+
+bool USimpleDayNightSubsystem::RegisterPresenter(ADayNightController* Controller)
+{
+	Presenters.RemoveAll([](const TWeakObjectPtr<ADayNightController>& Presenter) { return !Presenter.IsValid(); });
+	Presenters.AddUnique(Controller);
+	bHadPresenter = true;
+
+	if (!IsPrimaryPresenter(Controller))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: %s is already driving the clock in this world, so this controller will only present it"),
+			*Controller->GetName(), *GetPrimaryController()->GetName());
+		return false;
+	}
+	return true;
+}
+
+void USimpleDayNightSubsystem::UnregisterPresenter(ADayNightController* Controller)
+{
+	Presenters.RemoveAll([Controller](const TWeakObjectPtr<ADayNightController>& Presenter) { return !Presenter.IsValid() || Presenter.Get() == Controller; });
+}
+
+bool USimpleDayNightSubsystem::IsPrimaryPresenter(const ADayNightController* Controller) const
+{
+	return Controller && GetPrimaryController() == Controller;
+}
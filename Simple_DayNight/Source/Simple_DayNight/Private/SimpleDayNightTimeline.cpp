@@ -0,0 +1,188 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "SimpleDayNightTimeline.h"
+#include "Algo/BinarySearch.h"
+
+int64 FSimpleDayNightTimeline::ToWorldTicks(double Seconds)
+{
+	return FMath::RoundToInt64(Seconds * WorldTicksPerSecond);
+}
+
+int64 FSimpleDayNightTimeline::ToClockTicks(const FSimpleDayNightTime& Time)
+{
+	return Time.Day * ClockTicksPerDay + FMath::RoundToInt64(Time.Hour * ClockTicksPerHour);
+}
+
+FSimpleDayNightTime FSimpleDayNightTimeline::ToTime(int64 ClockTick)
+{
+	//Floor, so times before day 0 still get an hour in [0, 24).
+	int64 Day = ClockTick / ClockTicksPerDay;
+	int64 Remainder = ClockTick % ClockTicksPerDay;
+	if (Remainder < 0)
+	{
+		Day--;
+		Remainder += ClockTicksPerDay;
+	}
+	return FSimpleDayNightTime(Day, (double)Remainder / ClockTicksPerHour);
+}
+
+int64 FSimpleDayNightTimeline::ToRate(double HoursPerSecond)
+{
+	return FMath::RoundToInt64(HoursPerSecond * ClockTicksPerHour);
+}
+
+int64 FSimpleDayNightTimeline::GetRateToCover(int64 ClockTicks, int64 WorldTicks)
+{
+	return WorldTicks > 0 ? MulDiv(ClockTicks, WorldTicksPerSecond, WorldTicks) : 0;
+}
+
+int64 FSimpleDayNightTimeline::MulDiv(int64 A, int64 B, int64 C)
+{
+	//A*B/C = (A/C)*B + (A%C)*(B/C) + (A%C)*(B%C)/C, and both remainders are under C.
+	const int64 Whole = A / C;
+	const int64 Part = A % C;
+	return Whole * B + Part * (B / C) + Part * (B % C) / C;
+}
+
+void FSimpleDayNightTimeline::Reset(int64 WorldTick, int64 ClockTick, int64 Rate)
+{
+	Segments.Reset();
+	Segments.Add({ WorldTick, ClockTick, Rate });
+}
+
+void FSimpleDayNightTimeline::AddSegment(int64 WorldTick, int64 ClockTick, int64 Rate)
+{
+	//Only record actual changes, so a replay has nothing to store between them.
+	const FSimpleDayNightClockSegment& Last = Segments.Last();
+	if (Last.WorldTick <= WorldTick && Last.Rate == Rate && Sample(WorldTick) == ClockTick)
+	{
+		return;
+	}
+
+	//Everything from WorldTick on is replaced, but the first segment always stays so there's something to sample.
+	const int32 First = Algo::LowerBoundBy(Segments, WorldTick, &FSimpleDayNightClockSegment::WorldTick);
+	Segments.SetNum(FMath::Max(First, 1));
+
+	if (Segments.Last().WorldTick >= WorldTick)
+	{
+		Segments.Last() = { WorldTick, ClockTick, Rate };
+	}
+	else
+	{
+		Segments.Add({ WorldTick, ClockTick, Rate });
+	}
+}
+
+void FSimpleDayNightTimeline::SetRate(int64 WorldTick, int64 Rate)
+{
+	AddSegment(WorldTick, Sample(WorldTick), Rate);
+}
+
+void FSimpleDayNightTimeline::Offset(int64 WorldTick, int64 ClockTicks)
+{
+	if (ClockTicks == 0)
+	{
+		return;
+	}
+
+	int32 Index = FindSegment(WorldTick);
+	if (Segments[Index].WorldTick == WorldTick)
+	{
+		Segments[Index].ClockTick += ClockTicks;
+	}
+	else
+	{
+		const FSimpleDayNightClockSegment Inserted = { WorldTick, Sample(WorldTick) + ClockTicks, Segments[Index].Rate };
+		Segments.Insert(Inserted, ++Index);
+	}
+
+	for (int32 Later = Index + 1; Later < Segments.Num(); ++Later)
+	{
+		Segments[Later].ClockTick += ClockTicks;
+	}
+}
+
+void FSimpleDayNightTimeline::Slew(int64 WorldTick, int64 ClockTicks, int64 SlewWorldTicks, int64 Rate)
+{
+	const int64 StartTick = Sample(WorldTick);
+
+	//Catching up from ahead never runs the clock backwards, it takes as long as it needs at half the rate. A stopped clock just jumps back.
+	if (ClockTicks < 0 && SlewWorldTicks > 0)
+	{
+		SlewWorldTicks = Rate > 0 ? FMath::Max(SlewWorldTicks, MulDiv(-ClockTicks, WorldTicksPerSecond * 2, Rate)) : 0;
+	}
+
+	if (SlewWorldTicks <= 0 || ClockTicks == 0)
+	{
+		AddSegment(WorldTick, StartTick + ClockTicks, Rate);
+		return;
+	}
+
+	//Lands exactly where the clock would be at Rate with the gap closed, the covering rate only rounds on the way there.
+	const int64 EndWorldTick = WorldTick + SlewWorldTicks;
+	const int64 EndTick = StartTick + ClockTicks + MulDiv(SlewWorldTicks, Rate, WorldTicksPerSecond);
+	AddSegment(WorldTick, StartTick, GetRateToCover(EndTick - StartTick, SlewWorldTicks));
+	AddSegment(EndWorldTick, EndTick, Rate);
+}
+
+int64 FSimpleDayNightTimeline::Sample(int64 WorldTick) const
+{
+	const FSimpleDayNightClockSegment& Segment = Segments[FindSegment(WorldTick)];
+	return Segment.ClockTick + MulDiv(WorldTick - Segment.WorldTick, Segment.Rate, WorldTicksPerSecond);
+}
+
+void FSimpleDayNightTimeline::TrimBefore(int64 WorldTick)
+{
+	const int32 Index = FindSegment(WorldTick);
+	if (Index > 0)
+	{
+		Segments.RemoveAt(0, Index);
+	}
+}
+
+FSimpleDayNightTimelineSnapshot FSimpleDayNightTimeline::Snapshot(int64 WorldTick) const
+{
+	const int32 Index = FindSegment(WorldTick);
+
+	FSimpleDayNightTimelineSnapshot Result;
+	Result.Segments.Append(Segments.GetData() + Index, Segments.Num() - Index);
+	return Result;
+}
+
+void FSimpleDayNightTimeline::Restore(const FSimpleDayNightTimelineSnapshot& InSnapshot)
+{
+	if (!InSnapshot.IsValid())
+	{
+		return;
+	}
+
+	//The history from before the snapshot hasn't changed since, only what came after it.
+	const int32 First = Algo::LowerBoundBy(Segments, InSnapshot.Segments[0].WorldTick, &FSimpleDayNightClockSegment::WorldTick);
+	Segments.SetNum(First);
+	Segments.Append(InSnapshot.Segments.GetData(), InSnapshot.Segments.Num());
+}
+
+int32 FSimpleDayNightTimeline::FindSegment(int64 WorldTick) const
+{
+	return FMath::Max(Algo::UpperBoundBy(Segments, WorldTick, &FSimpleDayNightClockSegment::WorldTick) - 1, 0);
+}
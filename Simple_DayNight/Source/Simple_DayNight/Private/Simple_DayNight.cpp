@@ -21,6 +21,7 @@
 //SOFTWARE.
 
 #include "Simple_DayNight.h"
+#include "SimpleDayNightConfigWriter.h"
 
 #include "Misc/ConfigCacheIni.h"
 #include "Misc/ConfigUtilities.h"
@@ -39,6 +40,9 @@ void FSimple_DayNightModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	// Write out any settings still waiting for their save delay
+	FSimpleDayNightConfigWriter::Get().Flush();
 }
 
 #undef LOCTEXT_NAMESPACE
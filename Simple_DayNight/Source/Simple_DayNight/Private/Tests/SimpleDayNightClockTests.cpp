@@ -0,0 +1,645 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "SimpleDayNightEventScheduler.h"
+#include "SimpleDayNightReplicatedClock.h"
+#include "SimpleDayNightSnapshot.h"
+#include "SimpleDayNightTimeline.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightEventTimesTest, "SimpleDayNight.Events.EventTimes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightEventTimesTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	FSimpleDayNightTime EventTime;
+
+	TestTrue(TEXT("Next noon found"), FSimpleDayNightEventScheduler::FindNextEvent(ECelestialEvent::Noon, FSimpleDayNightTime(3, 12.0), Params, EventTime));
+	TestTrue(TEXT("Next noon is strictly after"), EventTime == FSimpleDayNightTime(4, 12.0));
+
+	//The sun is on the horizon at sunrise and sunset, and they're balanced around noon.
+	for (int64 Day = 0; Day < 20; ++Day)
+	{
+		FSimpleDayNightTime Sunrise, Sunset;
+		TestTrue(TEXT("Sunrise found"), FSimpleDayNightEventScheduler::FindSunCrossing(true, Day, Params, Sunrise));
+		TestTrue(TEXT("Sunset found"), FSimpleDayNightEventScheduler::FindSunCrossing(false, Day, Params, Sunset));
+		TestNearlyEqual(FString::Printf(TEXT("Sun elevation at sunrise on day %lld"), Day), FSimpleDayNightEphemeris::GetSunElevation(Sunrise, Params), 0.0, 0.05);
+		TestNearlyEqual(FString::Printf(TEXT("Sun elevation at sunset on day %lld"), Day), FSimpleDayNightEphemeris::GetSunElevation(Sunset, Params), 0.0, 0.05);
+		TestNearlyEqual(FString::Printf(TEXT("Sunrise and sunset around noon on day %lld"), Day), (Sunrise.Hour + Sunset.Hour) * 0.5, 12.0, 0.25);
+	}
+
+	//No sunrise in polar night, but there is one once spring comes.
+	Params.Latitude = 80.0;
+	TestFalse(TEXT("No sunrise on the winter solstice at 80 degrees north"), FSimpleDayNightEventScheduler::FindSunCrossing(true, 0, Params, EventTime));
+	TestTrue(TEXT("Next sunrise at 80 degrees north found"), FSimpleDayNightEventScheduler::FindNextEvent(ECelestialEvent::Sunrise, FSimpleDayNightTime(0, 0.0), Params, EventTime));
+	TestTrue(TEXT("Next sunrise at 80 degrees north is after the solstice"), EventTime.Day > 0 && EventTime.Day < (int64)(Params.SeasonLength * 4.0));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightEventSchedulerTest, "SimpleDayNight.Events.Scheduler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightEventSchedulerTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	FSimpleDayNightEventScheduler Scheduler;
+
+	TArray<TPair<ECelestialEvent, FSimpleDayNightTime>> Fired;
+	FSimpleDayNightTime Time(0, 6.0);
+
+	for (const ECelestialEvent Event : { ECelestialEvent::Noon, ECelestialEvent::Sunset, ECelestialEvent::SpringEquinox })
+	{
+		Scheduler.Register(Event, 0.0, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateLambda([&Fired, &Time](ECelestialEvent InEvent, double)
+		{
+			Fired.Emplace(InEvent, Time);
+		}));
+	}
+	const FDelegateHandle Early = Scheduler.Register(ECelestialEvent::Sunset, -0.5, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateLambda([&Fired, &Time](ECelestialEvent, double)
+	{
+		Fired.Emplace(ECelestialEvent::Midnight, Time);
+	}));
+
+	//The first AdvanceTo only schedules.
+	Scheduler.AdvanceTo(Time, Params);
+	TestEqual(TEXT("Nothing fires when scheduling"), Fired.Num(), 0);
+
+	//Six and a bit days in frame sized steps. Seasons are five days, so the spring equinox comes along too.
+	const double Step = 0.01;
+	for (int32 Index = 0; Index < 24 * 6 * 100 + 50; ++Index)
+	{
+		Time.AddHours(Step);
+		Scheduler.AdvanceTo(Time, Params);
+	}
+
+	int32 Noons = 0, Sunsets = 0, EarlySunsets = 0, Equinoxes = 0;
+	for (int32 Index = 0; Index < Fired.Num(); ++Index)
+	{
+		Noons += Fired[Index].Key == ECelestialEvent::Noon;
+		Sunsets += Fired[Index].Key == ECelestialEvent::Sunset;
+		EarlySunsets += Fired[Index].Key == ECelestialEvent::Midnight;
+		Equinoxes += Fired[Index].Key == ECelestialEvent::SpringEquinox;
+
+		if (Index > 0)
+		{
+			TestFalse(TEXT("Events fire in order"), Fired[Index].Value < Fired[Index - 1].Value);
+		}
+	}
+	TestEqual(TEXT("Noons"), Noons, 6);
+	TestEqual(TEXT("Sunsets"), Sunsets, 6);
+	TestEqual(TEXT("Half hour before sunset"), EarlySunsets, 6);
+	TestEqual(TEXT("Spring equinoxes"), Equinoxes, 1);
+
+	FSimpleDayNightTime Scheduled;
+	TestTrue(TEXT("Early sunset is scheduled"), Scheduler.GetScheduledTime(Early, Scheduled));
+	FSimpleDayNightTime Sunset;
+	FSimpleDayNightEventScheduler::FindNextEvent(ECelestialEvent::Sunset, Time, Params, Sunset);
+	TestNearlyEqual(TEXT("Early sunset is half an hour before sunset"), Sunset.HoursSince(Scheduled), 0.5, 1e-9);
+
+	//Jumps longer than the catch up limit and going backwards reschedule without firing.
+	Fired.Reset();
+	Time.AddHours(24.0 * 10.0);
+	Scheduler.AdvanceTo(Time, Params);
+	Time.AddHours(-24.0 * 3.0);
+	Scheduler.AdvanceTo(Time, Params);
+	TestEqual(TEXT("Nothing fires on long jumps"), Fired.Num(), 0);
+
+	Scheduler.Unregister(Early);
+	TestFalse(TEXT("Unregistered subscription isn't scheduled"), Scheduler.GetScheduledTime(Early, Scheduled));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightEventCollapseTest, "SimpleDayNight.Events.Collapse", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightEventCollapseTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	FSimpleDayNightEventScheduler Scheduler;
+
+	TArray<ECelestialEvent> Fired;
+	for (const ECelestialEvent Event : { ECelestialEvent::Sunset, ECelestialEvent::Noon, ECelestialEvent::Sunrise })
+	{
+		Scheduler.Register(Event, 0.0, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateLambda([&Fired](ECelestialEvent InEvent, double)
+		{
+			Fired.Add(InEvent);
+		}));
+	}
+
+	FSimpleDayNightTime Time(0, 9.0);
+	Scheduler.AdvanceTo(Time, Params);
+
+	//A three day warp, the way the subsystem runs one: catch up limit raised and events held back until it lands.
+	Scheduler.SetMaxCatchUpHours(24.0 * 3.0 + 1.0);
+	Scheduler.BeginCollapse();
+	for (int32 Index = 0; Index < 3 * 24; ++Index)
+	{
+		Time.AddHours(1.0);
+		Scheduler.AdvanceTo(Time, Params);
+	}
+	TestEqual(TEXT("Nothing fires during a collapsed warp"), Fired.Num(), 0);
+
+	Scheduler.EndCollapse();
+	TestEqual(TEXT("Each passed event fires once"), Fired.Num(), 3);
+	if (Fired.Num() == 3)
+	{
+		//The warp lands at 9am, after that morning's sunrise, so the last of each was noon, then sunset, then sunrise.
+		TestTrue(TEXT("Collapsed events fire in the order they last happened"), Fired[0] == ECelestialEvent::Noon && Fired[1] == ECelestialEvent::Sunset && Fired[2] == ECelestialEvent::Sunrise);
+	}
+
+	//Without collapsing, the same warp in one step fires every event in between.
+	Fired.Reset();
+	Time.AddHours(24.0 * 3.0);
+	Scheduler.AdvanceTo(Time, Params);
+	TestEqual(TEXT("Uncollapsed warp fires every event"), Fired.Num(), 9);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightEventOffsetsTest, "SimpleDayNight.Events.OddOffsetsFireOnce", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightEventOffsetsTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	const double YearHours = Params.SeasonLength * 4.0 * 24.0;
+
+	//Offsets that aren't exact in binary, so taking them off and adding them back rounds.
+	const double Offsets[] = { 2.2, 3.7, 0.9, -1.3, 0.1 };
+	const ECelestialEvent Events[] = { ECelestialEvent::Sunrise, ECelestialEvent::Sunset, ECelestialEvent::Noon, ECelestialEvent::SpringEquinox, ECelestialEvent::WinterSolstice };
+
+	FRandomStream Random(20241017);
+	for (int32 Trial = 0; Trial < 4; ++Trial)
+	{
+		FSimpleDayNightEventScheduler Scheduler;
+		FSimpleDayNightTime Time(Random.RandRange(0, 10000), Random.FRandRange(0.0f, 24.0f));
+		const FSimpleDayNightTime Start = Time;
+
+		//Clock time of every firing, per event and offset
+		TMap<TPair<ECelestialEvent, double>, TArray<FSimpleDayNightTime>> Fired;
+		for (const ECelestialEvent Event : Events)
+		{
+			for (const double Offset : Offsets)
+			{
+				Scheduler.Register(Event, Offset, FSimpleDayNightEventScheduler::FOnCelestialEvent::FDelegate::CreateLambda([&Fired, &Time](ECelestialEvent InEvent, double InOffset)
+				{
+					Fired.FindOrAdd(TPair<ECelestialEvent, double>(InEvent, InOffset)).Add(Time);
+				}));
+			}
+		}
+
+		//Small uneven steps, so no event can legitimately fire twice in one.
+		Scheduler.AdvanceTo(Time, Params);
+		while (Time.HoursSince(Start) < YearHours * 3.0)
+		{
+			Time.AddHours(Random.FRandRange(0.05f, 0.5f));
+			Scheduler.AdvanceTo(Time, Params);
+		}
+
+		for (const ECelestialEvent Event : Events)
+		{
+			const bool bDaily = Event == ECelestialEvent::Sunrise || Event == ECelestialEvent::Sunset || Event == ECelestialEvent::Noon;
+			const double Period = bDaily ? 24.0 : YearHours;
+			for (const double Offset : Offsets)
+			{
+				const TArray<FSimpleDayNightTime>* Times = Fired.Find(TPair<ECelestialEvent, double>(Event, Offset));
+				const int32 Num = Times ? Times->Num() : 0;
+				const int32 Expected = FMath::RoundToInt(YearHours * 3.0 / Period);
+				const FString What = FString::Printf(TEXT("%s with offset %.1f, trial %d"), *UEnum::GetValueAsString(Event), Offset, Trial);
+
+				TestTrue(What + TEXT(" fires once per period"), FMath::Abs(Num - Expected) <= 1);
+				for (int32 Index = 1; Index < Num; ++Index)
+				{
+					if (!TestTrue(What + TEXT(" never fires twice in a row"), (*Times)[Index].HoursSince((*Times)[Index - 1]) > Period * 0.5))
+					{
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	//An equinox taken from a hair before itself is next year's, not the same one again.
+	FSimpleDayNightTime Equinox;
+	TestTrue(TEXT("Equinox found"), FSimpleDayNightEventScheduler::FindNextEvent(ECelestialEvent::SpringEquinox, FSimpleDayNightTime(3, 7.0), Params, Equinox));
+	FSimpleDayNightTime AlmostEquinox = Equinox;
+	AlmostEquinox.AddHours(-1e-12);
+	FSimpleDayNightTime Next;
+	TestTrue(TEXT("Next equinox found"), FSimpleDayNightEventScheduler::FindNextEvent(ECelestialEvent::SpringEquinox, AlmostEquinox, Params, Next));
+	TestNearlyEqual(TEXT("Next equinox is a year later"), Next.HoursSince(Equinox), YearHours, 1e-6);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightReplicatedClockTest, "SimpleDayNight.Replication.Clock", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightReplicatedClockTest::RunTest(const FString& Parameters)
+{
+	for (const int64 Day : { (int64)0, (int64)1, (int64)-3, (int64)250000 })
+	{
+		FSimpleDayNightReplicatedClock Sent;
+		Sent.EpochDay = Day;
+		Sent.EpochHour = 17.123456789;
+		Sent.EpochServerTime = 1234.5;
+		Sent.LengthOfDay = 10.0f;
+		Sent.SeasonLength = 4.0f;
+
+		FBitWriter Writer(0, true);
+		bool bSuccess = false;
+		Sent.NetSerialize(Writer, nullptr, bSuccess);
+		TestTrue(TEXT("Clock serialized"), bSuccess);
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		FSimpleDayNightReplicatedClock Received;
+		Received.NetSerialize(Reader, nullptr, bSuccess);
+		TestTrue(TEXT("Clock deserialized"), bSuccess);
+
+		TestEqual(FString::Printf(TEXT("Day %lld round trips"), Day), Received.EpochDay, Day);
+		TestNearlyEqual(TEXT("Hour round trips within the quantization"), Received.EpochHour, Sent.EpochHour, 1e-8);
+		TestTrue(TEXT("Clock fits in a small packet"), Sent.GetSerializedSize() <= 24);
+
+		//Both ends extrapolate to the same time.
+		TestNearlyEqual(TEXT("Extrapolated a minute later"), Received.Extrapolate(1294.5).HoursSince(Sent.Extrapolate(1294.5)), 0.0, 1e-6);
+	}
+
+	//A warp round trips and clients extrapolate along it to the target, then on at the normal rate.
+	{
+		FSimpleDayNightReplicatedClock Sent;
+		Sent.EpochDay = 2;
+		Sent.EpochHour = 20.0;
+		Sent.EpochServerTime = 100.0;
+		Sent.WarpSerial = 7;
+		Sent.WarpTargetDay = 3;
+		Sent.WarpTargetHour = 6.0;
+		Sent.WarpEndServerTime = 105.0;
+		Sent.bCollapseWarpEvents = true;
+
+		FBitWriter Writer(0, true);
+		bool bSuccess = false;
+		Sent.NetSerialize(Writer, nullptr, bSuccess);
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		FSimpleDayNightReplicatedClock Received;
+		Received.NetSerialize(Reader, nullptr, bSuccess);
+
+		TestEqual(TEXT("Warp serial round trips"), Received.WarpSerial, Sent.WarpSerial);
+		TestTrue(TEXT("Warp round trips"), Received.IsWarping() && Received.bCollapseWarpEvents && Received.GetWarpTarget() == Sent.GetWarpTarget());
+		TestNearlyEqual(TEXT("Halfway through the warp"), Received.Extrapolate(102.5).HoursSince(FSimpleDayNightTime(3, 1.0)), 0.0, 1e-6);
+		TestNearlyEqual(TEXT("After the warp"), Received.Extrapolate(165.0).HoursSince(FSimpleDayNightTime(3, 8.4)), 0.0, 1e-6);
+
+		//Nothing but the serial is sent once it's over.
+		Sent.WarpEndServerTime = 0.0;
+		FBitWriter IdleWriter(0, true);
+		Sent.NetSerialize(IdleWriter, nullptr, bSuccess);
+		TestTrue(TEXT("Idle warp state is about a byte"), IdleWriter.GetNumBytes() < Writer.GetNumBytes() - 8);
+	}
+
+	//Small errors close smoothly, big ones snap.
+	TestEqual(TEXT("Small error is closed gradually"), FSimpleDayNightReplicatedClock::GetCorrectionTime(0.1, 2.0f, 1.0), 2.0f);
+	TestEqual(TEXT("Big error snaps"), FSimpleDayNightReplicatedClock::GetCorrectionTime(-3.0, 2.0f, 1.0), 0.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightReplicatedDriftTest, "SimpleDayNight.Replication.DriftAndBandwidth", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightReplicatedDriftTest::RunTest(const FString& Parameters)
+{
+	typedef FSimpleDayNightTimeline FTimeline;
+
+	//The bounds the README promises: within a quarter second of the server's clock, and well under 64 bytes a minute.
+	const double MaxErrorSeconds = 0.25;
+	const double MaxBytesPerMinute = 64.0;
+
+	const double Duration = 600.0;
+	const double FrameTime = 1.0 / 60.0;
+	const double HeartbeatInterval = 60.0;
+	const float SeasonLength = 5.0f;
+	const auto GetLengthOfDay = [](double ServerTime) { return ServerTime >= 150.0 && ServerTime < 330.0 ? 7.0f : 10.0f; };
+	const auto ToRate = [](float LengthOfDay) { return FTimeline::ToRate(24.0 / LengthOfDay / 60.0); };
+
+	//Server time and client world time are a few seconds apart, and the client's synced server time is a little off every frame.
+	const double ClientWorldOffset = 3.7;
+	FRandomStream Random(7);
+
+	FTimeline Server;
+	Server.Reset(0, FTimeline::ToClockTicks(FSimpleDayNightTime(1, 6.0)), ToRate(GetLengthOfDay(0.0)));
+	FTimeline Client;
+	bool bClientStarted = false;
+
+	//Updates on their way to the client, with the server time they arrive at
+	TArray<TPair<double, FSimpleDayNightReplicatedClock>> InFlight;
+	FSimpleDayNightReplicatedClock Sent;
+	int64 BytesSent = 0;
+	double MaxErrorHours = 0.0;
+
+	for (double ServerTime = FrameTime; ServerTime <= Duration; ServerTime += FrameTime)
+	{
+		const int64 ServerTick = FTimeline::ToWorldTicks(ServerTime);
+		const float LengthOfDay = GetLengthOfDay(ServerTime);
+		Server.SetRate(ServerTick, ToRate(LengthOfDay));
+
+		//The server sends the same way the controller does, when the rate changes or the heartbeat is due.
+		if (!Sent.IsValid() || Sent.LengthOfDay != LengthOfDay || ServerTime - Sent.EpochServerTime >= HeartbeatInterval)
+		{
+			const FSimpleDayNightTime Time = Server.SampleTime(ServerTick);
+			Sent.EpochDay = Time.Day;
+			Sent.EpochHour = Time.Hour;
+			Sent.EpochServerTime = ServerTime;
+			Sent.LengthOfDay = LengthOfDay;
+			Sent.SeasonLength = SeasonLength;
+			BytesSent += Sent.GetSerializedSize();
+
+			FBitWriter Writer(0, true);
+			bool bSuccess = false;
+			Sent.NetSerialize(Writer, nullptr, bSuccess);
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FSimpleDayNightReplicatedClock Received;
+			Received.NetSerialize(Reader, nullptr, bSuccess);
+			InFlight.Emplace(ServerTime + Random.FRandRange(0.05f, 0.15f), Received);
+		}
+
+		const int64 ClientTick = FTimeline::ToWorldTicks(ServerTime + ClientWorldOffset);
+		const double SyncedServerTime = ServerTime + Random.FRandRange(-0.02f, 0.02f);
+		while (InFlight.Num() > 0 && InFlight[0].Key <= ServerTime)
+		{
+			//What OnRep_ReplicatedClock and UpdateClockReplication do with it.
+			const FSimpleDayNightReplicatedClock Received = InFlight[0].Value;
+			InFlight.RemoveAt(0);
+
+			const FSimpleDayNightTime Target = Received.Extrapolate(SyncedServerTime);
+			if (!bClientStarted)
+			{
+				bClientStarted = true;
+				Client.Reset(ClientTick, FTimeline::ToClockTicks(Target), ToRate(Received.LengthOfDay));
+				continue;
+			}
+
+			Client.SetRate(ClientTick, ToRate(Received.LengthOfDay));
+			const double ErrorHours = Target.HoursSince(Client.SampleTime(ClientTick));
+			Client.Slew(ClientTick, FMath::RoundToInt64(ErrorHours * FTimeline::ClockTicksPerHour), FTimeline::ToWorldTicks(FSimpleDayNightReplicatedClock::GetCorrectionTime(ErrorHours, 2.0f, 1.0)), ToRate(Received.LengthOfDay));
+		}
+
+		if (bClientStarted)
+		{
+			MaxErrorHours = FMath::Max(MaxErrorHours, FMath::Abs(Server.SampleTime(ServerTick).HoursSince(Client.SampleTime(ClientTick))));
+		}
+	}
+
+	//Measured against the fastest rate the clock ran at, so it's in seconds of world time.
+	const double MaxErrorAtRate = MaxErrorHours / (24.0 / 7.0 / 60.0);
+	const double BytesPerMinute = BytesSent / (Duration / 60.0);
+	AddInfo(FString::Printf(TEXT("Max error %.4f seconds, %.1f bytes a minute"), MaxErrorAtRate, BytesPerMinute));
+
+	TestTrue(TEXT("Client started"), bClientStarted);
+	TestTrue(TEXT("Client stays within the drift bound"), MaxErrorAtRate < MaxErrorSeconds);
+	TestTrue(TEXT("Clock stays within the bandwidth budget"), BytesPerMinute < MaxBytesPerMinute);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightTimelineTest, "SimpleDayNight.Clock.Timeline", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightTimelineTest::RunTest(const FString& Parameters)
+{
+	typedef FSimpleDayNightTimeline FTimeline;
+	const int64 Rate = FTimeline::ToRate(24.0 / 10.0 / 60.0);
+	const int64 Second = FTimeline::WorldTicksPerSecond;
+
+	for (const FSimpleDayNightTime& Time : { FSimpleDayNightTime(0, 6.0), FSimpleDayNightTime(-3, 23.5), FSimpleDayNightTime(250000, 0.25) })
+	{
+		TestTrue(FString::Printf(TEXT("Day %lld round trips through clock ticks"), Time.Day), FTimeline::ToTime(FTimeline::ToClockTicks(Time)) == Time);
+	}
+	TestEqual(TEXT("MulDiv doesn't overflow on fast warps"), FTimeline::MulDiv(999999, 300000000000000000, Second), (int64)299999700000000000);
+
+	//The same world time reads the same clock however many frames it took to get there, and steady frames add nothing to the timeline.
+	FTimeline Slow, Fast;
+	Slow.Reset(0, FTimeline::ToClockTicks(FSimpleDayNightTime(0, 6.0)), Rate);
+	Fast = Slow;
+	for (int64 Tick = 0; Tick <= 3600 * Second; Tick += Second / 30)
+	{
+		Slow.SetRate(Tick, Rate);
+	}
+	for (int64 Tick = 0; Tick <= 3600 * Second; Tick += Second / 144)
+	{
+		Fast.SetRate(Tick, Rate);
+	}
+	TestEqual(TEXT("Steady frames record nothing"), Slow.Num() + Fast.Num(), 2);
+	TestEqual(TEXT("Same clock at any frame rate"), Slow.Sample(3600 * Second), Fast.Sample(3600 * Second));
+	TestTrue(TEXT("An hour of world time is exactly 144 in-game hours"), Slow.SampleTime(3600 * Second) == FSimpleDayNightTime(6, 6.0));
+
+	//Rate changes only apply from when they're made.
+	FTimeline Timeline = Slow;
+	Timeline.SetRate(60 * Second, Rate * 2);
+	TestEqual(TEXT("Rate change keeps the past"), Timeline.Sample(30 * Second), Slow.Sample(30 * Second));
+	TestEqual(TEXT("Rate change applies after"), Timeline.Sample(90 * Second) - Timeline.Sample(60 * Second), (Slow.Sample(90 * Second) - Slow.Sample(60 * Second)) * 2);
+
+	//A warp of a year in a tenth of a second lands exactly on its target however its rate rounded.
+	const int64 WarpStartTick = 100 * Second;
+	const int64 WarpEndTick = WarpStartTick + Second / 10;
+	const int64 WarpFrom = Timeline.Sample(WarpStartTick);
+	const int64 WarpTo = WarpFrom + 365 * FTimeline::ClockTicksPerDay + 12345;
+	Timeline.AddSegment(WarpStartTick, WarpFrom, FTimeline::GetRateToCover(WarpTo - WarpFrom, WarpEndTick - WarpStartTick));
+	Timeline.AddSegment(WarpEndTick, WarpTo, Rate);
+	TestEqual(TEXT("Warp lands on its target"), Timeline.Sample(WarpEndTick), WarpTo);
+	TestNearlyEqual(TEXT("Halfway through the warp"), (double)(Timeline.Sample((WarpStartTick + WarpEndTick) / 2) - WarpFrom) / (WarpTo - WarpFrom), 0.5, 1e-6);
+	TestEqual(TEXT("On at the normal rate after the warp"), Timeline.Sample(WarpEndTick + Second) - WarpTo, Rate);
+
+	//Snapshot halfway through the warp, then mess the timeline up and put it back.
+	const FSimpleDayNightTimelineSnapshot Snapshot = Timeline.Snapshot(WarpStartTick + Second / 20);
+	const FTimeline Saved = Timeline;
+	TestEqual(TEXT("Snapshot holds the warp and its end"), Snapshot.Segments.Num(), 2);
+
+	Timeline.Offset(WarpStartTick + Second / 40, FTimeline::ClockTicksPerHour);
+	TestEqual(TEXT("Offset moves the warp's landing with it"), Timeline.Sample(WarpEndTick), WarpTo + FTimeline::ClockTicksPerHour);
+	TestEqual(TEXT("Offset keeps the past"), Timeline.Sample(WarpStartTick), WarpFrom);
+	Timeline.AddSegment(WarpStartTick + Second / 20, 0, Rate * 3);
+
+	Timeline.Restore(Snapshot);
+	TestEqual(TEXT("Restore puts the segments back"), Timeline.Num(), Saved.Num());
+	for (const int64 Tick : { (int64)0, 60 * Second, WarpStartTick + Second / 40, WarpEndTick, 1000 * Second })
+	{
+		TestEqual(TEXT("Restored timeline samples the same"), Timeline.Sample(Tick), Saved.Sample(Tick));
+	}
+
+	//Trimming the history keeps everything from then on.
+	Timeline.TrimBefore(WarpEndTick);
+	TestEqual(TEXT("Trimmed to the segment in effect"), Timeline.Num(), 1);
+	TestEqual(TEXT("Trim keeps the present"), Timeline.Sample(1000 * Second), Saved.Sample(1000 * Second));
+
+	//A snapshot from before the trim still restores.
+	Timeline.Restore(Snapshot);
+	TestEqual(TEXT("Restore after trim"), Timeline.Sample(WarpStartTick + Second / 20), Saved.Sample(WarpStartTick + Second / 20));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightCorrectingClientTest, "SimpleDayNight.Clock.CorrectingClient", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightCorrectingClientTest::RunTest(const FString& Parameters)
+{
+	typedef FSimpleDayNightTimeline FTimeline;
+	const int64 Second = FTimeline::WorldTicksPerSecond;
+	const int64 Rate = FTimeline::ToRate(24.0 / 10.0 / 60.0);
+	const int64 FastRate = FTimeline::ToRate(24.0 / 7.0 / 60.0);
+	const int64 Start = FTimeline::ToClockTicks(FSimpleDayNightTime(2, 6.0));
+
+	//The server changes its rate now and then, and sends an update every 10 seconds that arrives 80ms later.
+	FTimeline Server;
+	Server.Reset(0, Start, Rate);
+	Server.SetRate(33 * Second + 123457, FastRate);
+	Server.SetRate(71 * Second + 654321, Rate);
+	const int64 UpdateInterval = 10 * Second;
+	const int64 Latency = Second * 8 / 100;
+	const int64 End = 120 * Second;
+	const int32 NumUpdates = (int32)(End / UpdateInterval);
+
+	//A client that joined 30 in-game seconds behind, correcting towards each update once at whatever frame it arrives on.
+	const auto RunClient = [&](int64 FrameTicks, int64& OutMaxSegments)
+	{
+		FTimeline Client;
+		Client.Reset(0, Start - FTimeline::ClockTicksPerHour / 120, Rate);
+		OutMaxSegments = Client.Num();
+
+		int64 NextUpdate = UpdateInterval;
+		int64 Previous = Client.Sample(0);
+		for (int64 Tick = FrameTicks; Tick <= End; Tick += FrameTicks)
+		{
+			if (Tick >= NextUpdate + Latency)
+			{
+				//Extrapolating the update is exact while the rate holds, and the update carries the rate to go on at.
+				const int64 Error = Server.Sample(Tick) - Client.Sample(Tick);
+				const int64 UpdateRate = Server.GetSegment(NextUpdate).Rate;
+				const double ErrorHours = (double)Error / FTimeline::ClockTicksPerHour;
+				Client.Slew(Tick, Error, FTimeline::ToWorldTicks(FSimpleDayNightReplicatedClock::GetCorrectionTime(ErrorHours, 2.0f, 1.0)), UpdateRate);
+				NextUpdate += UpdateInterval;
+			}
+			OutMaxSegments = FMath::Max<int64>(OutMaxSegments, Client.Num());
+
+			const int64 Now = Client.Sample(Tick);
+			if (!TestTrue(TEXT("Clock never runs backwards"), Now >= Previous))
+			{
+				break;
+			}
+			Previous = Now;
+		}
+		return Client;
+	};
+
+	int64 SlowSegments = 0;
+	int64 FastSegments = 0;
+	const FTimeline Slow = RunClient(Second / 30, SlowSegments);
+	const FTimeline Fast = RunClient(Second / 144, FastSegments);
+
+	//The last update has been corrected towards for longer than the correction time by the end.
+	TestEqual(TEXT("30 fps client lands on the server's clock"), Slow.Sample(End), Server.Sample(End));
+	TestEqual(TEXT("Same clock at 30 and 144 fps"), Slow.Sample(End), Fast.Sample(End));
+	TestTrue(TEXT("Segments grow with updates, not frames"), SlowSegments <= 1 + 2 * NumUpdates && FastSegments <= 1 + 2 * NumUpdates);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightSnapshotTest, "SimpleDayNight.Snapshot.PublishAndPredict", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightSnapshotTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	const double HoursPerSecond = 24.0 / 10.0 / 60.0;
+
+	FSimpleDayNightSnapshotBuffer Buffer;
+	FSimpleDayNightSnapshot Read;
+	TestFalse(TEXT("Nothing to read before the first publish"), Buffer.Read(Read));
+
+	for (int32 Index = 0; Index < 5; ++Index)
+	{
+		Buffer.Publish(FSimpleDayNightSnapshot::Make(FSimpleDayNightTime(Index, 6.0), Params, HoursPerSecond, Index * 600.0));
+	}
+	TestTrue(TEXT("Read after publishing"), Buffer.Read(Read));
+	TestEqual(TEXT("Latest snapshot is read"), Read.GetDayIndex(), (int64)4);
+
+	//Predicting ahead is the same as taking a snapshot at the later time.
+	FSimpleDayNightTime Later = Read.Time;
+	Later.AddHours(90.0 * HoursPerSecond);
+	const FSimpleDayNightSnapshot Predicted = Read.Predict(90.0);
+	const FSimpleDayNightSnapshot Expected = FSimpleDayNightSnapshot::Make(Later, Params, HoursPerSecond, Read.WorldTime + 90.0);
+	TestTrue(TEXT("Predicted time"), Predicted.Time == Expected.Time);
+	TestTrue(TEXT("Predicted sun direction"), Predicted.SunDirection.Equals(Expected.SunDirection, 1e-12));
+	TestNearlyEqual(TEXT("Predicted world time"), Predicted.WorldTime, Expected.WorldTime, 1e-9);
+	TestNearlyEqual(TEXT("Snapshot elevation matches the ephemeris"), Predicted.SunElevation, FSimpleDayNightEphemeris::GetSunElevation(Later, Params), 1e-9);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightGlobalSnapshotTest, "SimpleDayNight.Snapshot.OneGlobalPublisher", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightGlobalSnapshotTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	const double HoursPerSecond = 24.0 / 10.0 / 60.0;
+
+	//Stand-ins for two worlds' subsystems, publishing the way PublishSnapshot does.
+	int32 ServerWorld = 0;
+	int32 ClientWorld = 0;
+	const auto Publish = [&](const void* World, int64 Day)
+	{
+		if (FSimpleDayNightSnapshotBuffer::ClaimGlobal(World))
+		{
+			FSimpleDayNightSnapshotBuffer::Get().Publish(FSimpleDayNightSnapshot::Make(FSimpleDayNightTime(Day, 6.0), Params, HoursPerSecond, 0.0));
+		}
+	};
+
+	if (!FSimpleDayNightSnapshotBuffer::ClaimGlobal(&ServerWorld))
+	{
+		//A world that's playing already has it, which is just as good a test.
+		TestFalse(TEXT("Nobody else gets the global buffer while a world has it"), FSimpleDayNightSnapshotBuffer::ClaimGlobal(&ClientWorld));
+		return true;
+	}
+
+	FSimpleDayNightSnapshot Read;
+	for (int32 Frame = 0; Frame < 10; ++Frame)
+	{
+		Publish(&ServerWorld, 100);
+		Publish(&ClientWorld, 200);
+
+		TestTrue(TEXT("Read the global buffer"), FSimpleDayNightSnapshotBuffer::Get().Read(Read));
+		if (!TestEqual(TEXT("Only the first world publishes globally"), Read.GetDayIndex(), (int64)100))
+		{
+			break;
+		}
+	}
+
+	//Once it goes away the other world takes over.
+	FSimpleDayNightSnapshotBuffer::ReleaseGlobal(&ClientWorld);
+	TestFalse(TEXT("Releasing from the wrong world does nothing"), FSimpleDayNightSnapshotBuffer::ClaimGlobal(&ClientWorld));
+	FSimpleDayNightSnapshotBuffer::ReleaseGlobal(&ServerWorld);
+	Publish(&ClientWorld, 200);
+	Publish(&ServerWorld, 100);
+	TestTrue(TEXT("Read after the handover"), FSimpleDayNightSnapshotBuffer::Get().Read(Read));
+	TestEqual(TEXT("The next world to publish owns it"), Read.GetDayIndex(), (int64)200);
+	FSimpleDayNightSnapshotBuffer::ReleaseGlobal(&ClientWorld);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,71 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "Misc/AutomationTest.h"
+#include "Curves/CurveFloat.h"
+#include "SimpleDayNightCurveTable.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightCurveTableTest, "SimpleDayNight.Curves.Table", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightCurveTableTest::RunTest(const FString& Parameters)
+{
+	//Night, a ramp through dawn, then full sun.
+	UCurveFloat* Intensity = NewObject<UCurveFloat>();
+	Intensity->FloatCurve.AddKey(-10.0f, 0.0f);
+	Intensity->FloatCurve.AddKey(10.0f, 100000.0f);
+
+	UCurveFloat* Season = NewObject<UCurveFloat>();
+	Season->FloatCurve.AddKey(0.0f, 0.5f);
+	Season->FloatCurve.AddKey(0.5f, 1.0f);
+	Season->FloatCurve.AddKey(1.0f, 0.5f);
+
+	FSimpleDayNightSkyCurves Curves;
+	Curves.SunIntensity = Intensity;
+
+	FSimpleDayNightCurveTable Table;
+	Table.Bake(Curves);
+	TestTrue(TEXT("Only the intensity is baked"), Table.HasChannel(FSimpleDayNightCurveTable::SunIntensity) && !Table.HasChannel(FSimpleDayNightCurveTable::SunColorR));
+
+	float Values[FSimpleDayNightCurveTable::NumChannels] = {};
+	for (const double Elevation : { -45.0, -10.0, -3.5, 0.0, 2.25, 10.0, 60.0 })
+	{
+		Table.Sample(Elevation, 0.0, Values);
+		TestNearlyEqual(FString::Printf(TEXT("Intensity at %.2f degrees"), Elevation), Values[FSimpleDayNightCurveTable::SunIntensity], Intensity->GetFloatValue((float)Elevation), 10.0f);
+	}
+
+	//The season curve scales the intensity and wraps round the year.
+	Curves.SeasonScale = Season;
+	Table.Bake(Curves);
+	Table.Sample(60.0, 0.5, Values);
+	TestNearlyEqual(TEXT("Full intensity at midsummer"), Values[FSimpleDayNightCurveTable::SunIntensity], 100000.0f, 1.0f);
+	Table.Sample(60.0, 0.99, Values);
+	TestNearlyEqual(TEXT("Half intensity at midwinter"), Values[FSimpleDayNightCurveTable::SunIntensity], 51250.0f, 1000.0f);
+
+	Table.Bake(FSimpleDayNightSkyCurves());
+	TestTrue(TEXT("No curves bakes nothing"), Table.IsEmpty() && Table.GetAllocatedSize() == 0);
+
+	return true;
+}
+
+#endif
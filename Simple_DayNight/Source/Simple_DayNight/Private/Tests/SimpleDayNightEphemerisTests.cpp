@@ -0,0 +1,240 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "Misc/AutomationTest.h"
+#include "SimpleDayNightEphemeris.h"
+#include "SimpleDayNightOrientationCache.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//These pin the sky math down so optimizations can be checked against it. None of them need a world, so they run fine with -nullrhi.
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightSolsticeElevationTest, "SimpleDayNight.Ephemeris.SolsticeAndEquinoxElevations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightSolsticeElevationTest::RunTest(const FString& Parameters)
+{
+	//Noon elevation is 90 - |Latitude - Declination|, and declination is -AxialTilt at the Northern Winter Solstice (noon on day 0),
+	//0 at the equinoxes and +AxialTilt at the Northern Summer Solstice, one, two and three seasons later.
+	for (const double Latitude : { 0.0, 34.0, 51.5, -34.0, 66.0 })
+	{
+		for (const double SeasonLength : { 1.0, 4.0, 30.0 })
+		{
+			FSimpleDayNightEphemerisParams Params;
+			Params.Latitude = Latitude;
+			Params.AxialTilt = 23.5;
+			Params.SeasonLength = SeasonLength;
+
+			const int64 Season = (int64)SeasonLength;
+			const TCHAR* Names[] = { TEXT("Winter solstice"), TEXT("Spring equinox"), TEXT("Summer solstice"), TEXT("Autumn equinox") };
+			const double Declinations[] = { -23.5, 0.0, 23.5, 0.0 };
+
+			for (int32 Index = 0; Index < 4; ++Index)
+			{
+				const FSimpleDayNightTime Noon(Season * Index, 12.0);
+				const double Expected = 90.0 - FMath::Abs(Latitude - Declinations[Index]);
+
+				TestNearlyEqual(FString::Printf(TEXT("%s noon elevation at latitude %.1f, seasons of %.0f days"), Names[Index], Latitude, SeasonLength),
+					FSimpleDayNightEphemeris::GetSunElevation(Noon, Params), Expected, 1e-6);
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightPrecisionTest, "SimpleDayNight.Ephemeris.LongRunPrecision", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightPrecisionTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	Params.SeasonLength = 4.0;
+
+	//Ten million days in, on a day that's a whole number of years from day 0, the sky should be exactly where it was on day 0.
+	const int64 FarDay = 10000000;
+	TestEqual(TEXT("Far day is a whole number of years in"), FarDay % 16, (int64)0);
+
+	for (const double Hour : { 0.0, 6.0, 12.25, 23.999 })
+	{
+		const FVector Near = FSimpleDayNightEphemeris::GetSunDirection(FSimpleDayNightTime(0, Hour), Params);
+		const FVector Far = FSimpleDayNightEphemeris::GetSunDirection(FSimpleDayNightTime(FarDay, Hour), Params);
+		TestTrue(FString::Printf(TEXT("Sun direction at hour %.3f matches after ten million days"), Hour), Near.Equals(Far, 1e-9));
+
+		const FQuat NearStars = FSimpleDayNightEphemeris::GetStarRotation(FSimpleDayNightTime(0, Hour), Params);
+		const FQuat FarStars = FSimpleDayNightEphemeris::GetStarRotation(FSimpleDayNightTime(FarDay, Hour), Params);
+		TestTrue(FString::Printf(TEXT("Star rotation at hour %.3f matches after ten million days"), Hour), NearStars.Equals(FarStars, 1e-9));
+	}
+
+	//A frame's worth of time added at a time for ten in-game hours, starting ten million days in, shouldn't drift.
+	FSimpleDayNightTime Time(FarDay, 6.0);
+	const double Step = 24.0 / (10.0 * 60.0) / 60.0;
+	const int32 Steps = 36000;
+	for (int32 Index = 0; Index < Steps; ++Index)
+	{
+		Time.AddHours(Step);
+	}
+	TestEqual(TEXT("Day after ten hours of small steps"), Time.Day, FarDay);
+	TestNearlyEqual(TEXT("Hour after ten hours of small steps"), Time.Hour, 6.0 + Step * Steps, 1e-6);
+
+	//Large Time Of Day values still split into the right day and hour.
+	const FSimpleDayNightTime FromHours = FSimpleDayNightTime::FromHours(24.0 * 1000000.0 + 6.25);
+	TestEqual(TEXT("Day from a million days of hours"), FromHours.Day, (int64)1000000);
+	TestNearlyEqual(TEXT("Hour from a million days of hours"), FromHours.Hour, 6.25, 1e-6);
+
+	//Going backwards across midnight borrows a day.
+	FSimpleDayNightTime Backwards(5, 1.0);
+	Backwards.AddHours(-2.0);
+	TestEqual(TEXT("Day after going back across midnight"), Backwards.Day, (int64)4);
+	TestNearlyEqual(TEXT("Hour after going back across midnight"), Backwards.Hour, 23.0, 1e-12);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightDirectionTest, "SimpleDayNight.Ephemeris.ClosedFormMatchesComponents", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightDirectionTest::RunTest(const FString& Parameters)
+{
+	//The closed form sun direction has to match the forward vector of the Sun component built from the Axis and relative rotations.
+	FSimpleDayNightEphemerisParams Params;
+	for (const double Latitude : { -60.0, 0.0, 34.0, 89.0 })
+	{
+		Params.Latitude = Latitude;
+		for (double Hours = 0.0; Hours < 24.0 * 16.0; Hours += 7.3)
+		{
+			const FSimpleDayNightTime Time = FSimpleDayNightTime::FromHours(Hours);
+			const FSimpleDayNightOrientation Orientation = FSimpleDayNightEphemeris::Evaluate(Time, Params);
+			const FVector FromComponents = (Orientation.Axis * Orientation.SunRelative).GetForwardVector();
+
+			TestTrue(FString::Printf(TEXT("Sun direction at latitude %.0f, %.1f hours"), Latitude, Hours),
+				FromComponents.Equals(FSimpleDayNightEphemeris::GetSunDirection(Time, Params), 1e-9));
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightBatchTest, "SimpleDayNight.Ephemeris.BatchMatchesScalar", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightBatchTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	Params.SeasonLength = 7.0;
+
+	//An odd count so the scalar tail is covered as well as the SIMD body.
+	FSimpleDayNightEphemerisBatch Batch;
+	for (int32 Index = 0; Index < 103; ++Index)
+	{
+		Batch.Add(FSimpleDayNightTime(Index * 3, Index * 0.37), -80.0f + Index * 1.5f);
+	}
+	FSimpleDayNightEphemeris::EvaluateBatch(Batch, Params.AxialTilt, Params.SeasonLength);
+
+	for (int32 Index = 0; Index < Batch.Num(); ++Index)
+	{
+		Params.Latitude = Batch.Latitudes[Index];
+		const FSimpleDayNightTime Time(Batch.Days[Index], Batch.Hours[Index]);
+
+		const FVector Direction = FSimpleDayNightEphemeris::GetSunDirection(Time, Params);
+		const FQuat Stars = FSimpleDayNightEphemeris::GetStarRotation(Time, Params);
+		const FVector BatchDirection(Batch.SunDirectionX[Index], Batch.SunDirectionY[Index], Batch.SunDirectionZ[Index]);
+		const FQuat BatchStars(Batch.StarRotationX[Index], Batch.StarRotationY[Index], Batch.StarRotationZ[Index], Batch.StarRotationW[Index]);
+
+		TestTrue(FString::Printf(TEXT("Batch sun direction %d"), Index), BatchDirection.Equals(Direction, 1e-4));
+		TestNearlyEqual(FString::Printf(TEXT("Batch sun elevation %d"), Index), (double)Batch.SunElevation[Index], FSimpleDayNightEphemeris::GetSunElevation(Time, Params), 1e-2);
+		TestTrue(FString::Printf(TEXT("Batch star rotation %d"), Index), FMath::Abs(BatchStars | Stars) >= 1.0 - 1e-6);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightBodiesTest, "SimpleDayNight.Ephemeris.BodiesMatchScalar", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightBodiesTest::RunTest(const FString& Parameters)
+{
+	FSimpleDayNightEphemerisParams Params;
+	Params.Latitude = -41.0;
+	Params.SeasonLength = 7.0;
+
+	//A body that never leaves the sun is the sun.
+	const FSimpleDayNightBodyOrbit SunOrbit{ 0.0, 0.0, 0.0 };
+	for (double Hours = 0.0; Hours < 24.0 * 30.0; Hours += 5.9)
+	{
+		const FSimpleDayNightTime Time = FSimpleDayNightTime::FromHours(Hours);
+		TestTrue(FString::Printf(TEXT("Sun as a body at %.1f hours"), Hours),
+			FSimpleDayNightEphemeris::GetBodyDirection(Time, Params, SunOrbit).Equals(FSimpleDayNightEphemeris::GetSunDirection(Time, Params), 1e-9));
+	}
+
+	//An odd count so the scalar tail is covered as well as the SIMD body.
+	FSimpleDayNightBodyBatch Batch;
+	for (int32 Index = 0; Index < 11; ++Index)
+	{
+		Batch.Add(FSimpleDayNightBodyOrbit{ Index * 17.3, Index * 0.09, -10.0 + Index * 2.0 });
+	}
+
+	for (double Hours = 0.0; Hours < 24.0 * 400.0; Hours += 61.7)
+	{
+		const FSimpleDayNightTime Time = FSimpleDayNightTime::FromHours(Hours);
+		FSimpleDayNightEphemeris::EvaluateBodies(Batch, Time, Params);
+
+		for (int32 Index = 0; Index < Batch.Num(); ++Index)
+		{
+			const FSimpleDayNightBodyOrbit Orbit{ Batch.SynodicPeriods[Index], Batch.PhaseOffsets[Index], Batch.Inclinations[Index] };
+			const FVector Direction = FSimpleDayNightEphemeris::GetBodyDirection(Time, Params, Orbit);
+			const double Phase = FSimpleDayNightEphemeris::GetBodyPhase(Time, Orbit);
+
+			TestTrue(FString::Printf(TEXT("Body %d direction at %.1f hours"), Index, Hours), FVector(Batch.DirectionX[Index], Batch.DirectionY[Index], Batch.DirectionZ[Index]).Equals(Direction, 1e-4));
+			TestNearlyEqual(FString::Printf(TEXT("Body %d illumination at %.1f hours"), Index, Hours), (double)Batch.Illumination[Index], (1.0 - FMath::Cos(Phase * 2.0 * PI)) * 0.5, 1e-4);
+		}
+	}
+
+	//Full moon at midnight is opposite the noon sun, so it's up when the sun is down.
+	const FSimpleDayNightBodyOrbit FullMoon{ 0.0, 0.5, 0.0 };
+	const FSimpleDayNightTime Midnight(10, 0.0);
+	const FSimpleDayNightTime Noon(10, 12.0);
+	TestTrue(TEXT("Full moon up at midnight"), FSimpleDayNightEphemeris::GetBodyDirection(Midnight, Params, FullMoon).Z < 0.0);
+	TestTrue(TEXT("Full moon down at noon"), FSimpleDayNightEphemeris::GetBodyDirection(Noon, Params, FullMoon).Z > 0.0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightCacheTest, "SimpleDayNight.Ephemeris.OrientationCacheError", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightCacheTest::RunTest(const FString& Parameters)
+{
+	//The README promises the default 96 keys per day are well under a thousandth of a degree off.
+	FSimpleDayNightEphemerisParams Params;
+	for (const double SeasonLength : { 1.0, 5.0 })
+	{
+		Params.SeasonLength = SeasonLength;
+		for (const int64 Day : { (int64)0, (int64)3, (int64)1000000 })
+		{
+			const double Error = FSimpleDayNightOrientationCache::MeasureMaxAngularError(Params, Day, 96);
+			TestTrue(FString::Printf(TEXT("96 keys per day on day %lld with seasons of %.0f days: %.6f degrees"), Day, SeasonLength, Error), Error < 1e-3);
+		}
+	}
+
+	//More keys shouldn't be worse.
+	TestTrue(TEXT("384 keys are at least as accurate as 24"),
+		FSimpleDayNightOrientationCache::MeasureMaxAngularError(Params, 2, 384) <= FSimpleDayNightOrientationCache::MeasureMaxAngularError(Params, 2, 24));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,156 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SimpleDayNightStarCatalog.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightStarCatalogCsvTest, "SimpleDayNight.Stars.ParseCsv", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightStarCatalogCsvTest::RunTest(const FString& Parameters)
+{
+	//HYG style: extra columns, RA in hours, a star with no color and a row that doesn't parse.
+	const FString Csv =
+		TEXT("id,proper,ra,dec,mag,ci\n")
+		TEXT("1,Polaris,2.5303,89.2641,1.97,0.636\n")
+		TEXT("2,Sirius,6.7525,-16.7161,-1.44,0.009\n")
+		TEXT("3,,12.0,0.0,5.5,\n")
+		TEXT("4,Broken,,,\n");
+
+	TArray<FSimpleDayNightStarCatalog::FStar> Stars;
+	FString Error;
+	TestTrue(TEXT("Parses"), FSimpleDayNightStarCatalog::ParseCsv(Csv, false, Stars, Error));
+	if (!TestEqual(TEXT("Rows that parse"), Stars.Num(), 3))
+	{
+		return false;
+	}
+
+	TestTrue(TEXT("Polaris is at the pole"), Stars[0].Direction.Z > 0.9998f);
+	TestNearlyEqual(TEXT("Sirius magnitude"), Stars[1].Magnitude, -1.44f, 1e-4f);
+	TestNearlyEqual(TEXT("Sirius color"), Stars[1].ColorIndex, 0.009f, 1e-4f);
+	TestTrue(TEXT("12h on the equator"), Stars[2].Direction.Equals(FVector3f(-1.0f, 0.0f, 0.0f), 1e-5f));
+	TestEqual(TEXT("Missing color is white"), Stars[2].ColorIndex, 0.0f);
+
+	//No header, RA in degrees.
+	Stars.Reset();
+	TestTrue(TEXT("Parses without a header"), FSimpleDayNightStarCatalog::ParseCsv(TEXT("90,0,3.0\n"), true, Stars, Error));
+	TestTrue(TEXT("90 degrees on the equator"), Stars.Num() == 1 && Stars[0].Direction.Equals(FVector3f(0.0f, 1.0f, 0.0f), 1e-5f));
+
+	TestFalse(TEXT("Header without dec"), FSimpleDayNightStarCatalog::ParseCsv(TEXT("ra,mag\n1,2\n"), false, Stars, Error));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimpleDayNightStarCatalogTest, "SimpleDayNight.Stars.Catalog", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FSimpleDayNightStarCatalogTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(42);
+	TArray<FSimpleDayNightStarCatalog::FStar> Stars;
+	Stars.SetNum(5000);
+	for (FSimpleDayNightStarCatalog::FStar& Star : Stars)
+	{
+		Star.Direction = FVector3f(Random.GetUnitVector());
+		Star.Magnitude = Random.FRandRange(-1.5f, 9.0f);
+		Star.ColorIndex = Random.FRandRange(-0.3f, 2.0f);
+	}
+
+	TArray<uint8> Bytes;
+	FSimpleDayNightStarCatalog::Write(Stars, Bytes);
+	TestEqual(TEXT("8 bytes a star"), Bytes.Num(), 16 + Stars.Num() * 8);
+
+	FSimpleDayNightStarCatalog Catalog;
+	if (!TestTrue(TEXT("Loads from memory"), Catalog.LoadFromMemory(TArray<uint8>(Bytes))) || !TestEqual(TEXT("Star count"), Catalog.Num(), Stars.Num()))
+	{
+		return false;
+	}
+
+	//Sorted brightest first, and every star survives the trip within the quantization.
+	Stars.StableSort([](const FSimpleDayNightStarCatalog::FStar& A, const FSimpleDayNightStarCatalog::FStar& B) { return A.Magnitude < B.Magnitude; });
+	double MaxAngle = 0.0;
+	for (int32 Index = 0; Index < Stars.Num(); ++Index)
+	{
+		const FSimpleDayNightStarCatalog::FStar Star = Catalog.GetStar(Index);
+		MaxAngle = FMath::Max(MaxAngle, FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp((double)(Star.Direction | Stars[Index].Direction), -1.0, 1.0))));
+		TestNearlyEqual(TEXT("Magnitude"), Star.Magnitude, Stars[Index].Magnitude, 0.001f);
+		TestNearlyEqual(TEXT("Color index"), Star.ColorIndex, Stars[Index].ColorIndex, 0.0125f + KINDA_SMALL_NUMBER);
+	}
+	TestTrue(FString::Printf(TEXT("Direction error %.4f degrees"), MaxAngle), MaxAngle < 0.01);
+
+	//Magnitude culling is a prefix.
+	int32 Brighter = 0;
+	for (const FSimpleDayNightStarCatalog::FStar& Star : Stars)
+	{
+		Brighter += FMath::RoundToInt(Star.Magnitude * 1000.0f) <= 4000 ? 1 : 0;
+	}
+	TestEqual(TEXT("Stars brighter than 4"), Catalog.GetNumBrighterThan(4.0f), Brighter);
+	TestEqual(TEXT("Nothing brighter than -2"), Catalog.GetNumBrighterThan(-2.0f), 0);
+	TestEqual(TEXT("Everything brighter than 10"), Catalog.GetNumBrighterThan(10.0f), Stars.Num());
+
+	//View culling keeps exactly the stars in the cone.
+	const FVector3f View = FVector3f(1.0f, 1.0f, 0.5f).GetSafeNormal();
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(20.0f));
+	TArray<int32> Indices;
+	Catalog.Cull(6.0f, View, CosHalfAngle, Indices);
+
+	int32 Expected = 0;
+	for (int32 Index = 0; Index < Catalog.GetNumBrighterThan(6.0f); ++Index)
+	{
+		Expected += (Catalog.GetStar(Index).Direction | View) >= CosHalfAngle ? 1 : 0;
+	}
+	TestEqual(TEXT("Stars in the view"), Indices.Num(), Expected);
+	TestTrue(TEXT("View culling keeps fewer"), Indices.Num() > 0 && Indices.Num() < Catalog.GetNumBrighterThan(6.0f));
+
+	Catalog.Cull(6.0f, FVector3f::ZeroVector, 1.0f, Indices);
+	TestEqual(TEXT("No view keeps the whole sky"), Indices.Num(), Catalog.GetNumBrighterThan(6.0f));
+
+	//From disk, mapped where the platform can.
+	const FString Filename = FPaths::AutomationTransientDir() / TEXT("SimpleDayNightStars.sdnstars");
+	TestTrue(TEXT("Writes the file"), FFileHelper::SaveArrayToFile(Bytes, *Filename));
+
+	FSimpleDayNightStarCatalog Mapped;
+	TestTrue(TEXT("Loads from disk"), Mapped.Load(Filename));
+	TestEqual(TEXT("Same star count from disk"), Mapped.Num(), Catalog.Num());
+	TestTrue(TEXT("Same brightest star from disk"), Mapped.Num() > 0 && Mapped.GetStar(0).Direction.Equals(Catalog.GetStar(0).Direction));
+	if (Mapped.IsMapped())
+	{
+		TestEqual(TEXT("Mapped catalog is off the heap"), (int32)Mapped.GetAllocatedSize(), 0);
+	}
+	Mapped.Reset();
+
+	//Anything else is turned away.
+	Bytes[0] ^= 0xFF;
+	TestFalse(TEXT("Rejects a bad magic number"), Catalog.LoadFromMemory(TArray<uint8>(Bytes)));
+	TestFalse(TEXT("Rejected catalog is empty"), Catalog.IsLoaded());
+	Bytes[0] ^= 0xFF;
+	Bytes.SetNum(Bytes.Num() - 1);
+	TestFalse(TEXT("Rejects a truncated file"), Catalog.LoadFromMemory(MoveTemp(Bytes)));
+
+	IFileManager::Get().Delete(*Filename);
+	return true;
+}
+
+#endif
@@ -24,6 +24,15 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "SimpleDayNightCommitScheduler.h"
+#include "SimpleDayNightCurveTable.h"
+#include "SimpleDayNightEphemeris.h"
+#include "SimpleDayNightOrientationCache.h"
+#include "SimpleDayNightReplicatedClock.h"
+#include "SimpleDayNightSkyBody.h"
+#include "SimpleDayNightSkyLightScheduler.h"
+#include "SimpleDayNightStarCatalog.h"
+#include "SimpleDayNightSubsystem.h"
 #include "DayNightController.generated.h"
 
 class UDirectionalLightComponent;
@@ -31,6 +40,24 @@ class UStaticMeshComponent;
 class USceneComponent;
 class UArrowComponent;
 class USkyAtmosphereComponent;
+class USkyLightComponent;
+class UInstancedStaticMeshComponent;
+class UMaterialParameterCollection;
+class UMaterialInterface;
+class UStaticMesh;
+struct FStreamableHandle;
+
+//How the star sphere's rotation gets to the GPU
+UENUM(BlueprintType)
+enum class EStarRotationMode : uint8
+{
+	//Rotate the SkySphere component every frame
+	Transform,
+	//Leave the SkySphere where it is and write the rotation quaternion to a vector parameter in StarRotationCollection
+	MaterialParameterCollection,
+	//Leave the SkySphere where it is and write the rotation quaternion to the SkySphere's custom primitive data at StarRotationDataIndex
+	CustomPrimitiveData
+};
 
 UCLASS(Config=SimpleDayNight, DefaultConfig)
 class SIMPLE_DAYNIGHT_API ADayNightController : public AActor
@@ -50,12 +77,157 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Sun"))
 	UDirectionalLightComponent* Sun;
 
+	//Transient, it's built from SkySphereMesh and SkySphereMaterial every time the controller is constructed or starts play
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Stars"))
 	UStaticMeshComponent* SkySphere;
 
+	//Mesh for the SkySphere. Loaded in the background when play starts (or when placed in the editor), the atmosphere is all there is of the sky until it arrives.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(Category="Stars"))
+	TSoftObjectPtr<UStaticMesh> SkySphereMesh;
+
+	//Material for the SkySphere, loaded along with the mesh. Leave empty to use the mesh's own star material.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(Category="Stars"))
+	TSoftObjectPtr<UMaterialInterface> SkySphereMaterial;
+
+	//How the star rotation is applied. Rotating a 100000 scaled mesh every frame dirties its transform, bounds and render proxy,
+	//the other modes leave the component alone and let the star material rotate its lookup direction by the inverse of the rotation quaternion.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Stars"))
+	EStarRotationMode StarRotationMode = EStarRotationMode::Transform;
+
+	//Collection the star rotation quaternion is written to in MaterialParameterCollection mode
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Stars", EditCondition="StarRotationMode==EStarRotationMode::MaterialParameterCollection"))
+	UMaterialParameterCollection* StarRotationCollection = nullptr;
+
+	//Vector parameter in StarRotationCollection the star rotation quaternion is written to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Stars", EditCondition="StarRotationMode==EStarRotationMode::MaterialParameterCollection"))
+	FName StarRotationParameter = TEXT("StarRotation");
+
+	//First of the four custom primitive data floats the star rotation quaternion is written to in CustomPrimitiveData mode
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Stars", ClampMin="0", EditCondition="StarRotationMode==EStarRotationMode::CustomPrimitiveData"))
+	int32 StarRotationDataIndex = 0;
+
+	//Stars from StarCatalogFile, one instance each, drawn instead of the SkySphere's texture once the catalog and StarMesh are loaded.
+	//Rotated as a whole with the sky whatever the StarRotationMode, which is one transform update for every star. Transient like the SkySphere.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Stars"))
+	UInstancedStaticMeshComponent* StarField;
+
+	//Binary catalog made by the SimpleDayNightStarCatalog commandlet. Mapped into memory when play starts. Leave empty to use the SkySphere's texture.
+	//Stage its folder as non-UFS (Directories to Always Stage as Non-UFS) so packaged builds can map it instead of reading it in.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Stars", RelativeToGameDir))
+	FFilePath StarCatalogFile;
+
+	//Mesh for each catalog star, like a small camera facing card. Per instance custom data 0 is the star's flux relative to a magnitude 0 star, 1 is its B-V color index.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(Category="Stars"))
+	TSoftObjectPtr<UStaticMesh> StarMesh;
+
+	//Material for StarMesh, loaded along with it. Leave empty to use the mesh's own.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(Category="Stars"))
+	TSoftObjectPtr<UMaterialInterface> StarMaterial;
+
+	//Faintest catalog star that's drawn. Higher shows more stars. Meant to be set per scalability level.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Stars"))
+	float StarMagnitudeLimit;
+
+	//Whether only the catalog stars around the view are kept, for telescopes and binoculars where a zoomed view can go much fainter than the whole sky could afford
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Stars"))
+	bool StarViewCulling = false;
+
+	//Degrees kept around the edge of the view when StarViewCulling. The stars are only culled again once the view gets this close to the edge of what's kept.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Stars", ClampMin="1.0", ClampMax="90.0", EditCondition="StarViewCulling"))
+	float StarViewMargin = 15.0f;
+
+	//Distance of the catalog stars from the controller
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Stars", ClampMin="1.0"))
+	float StarFieldRadius = 5000000.0f;
+
+	//Number of catalog stars being drawn
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Stars"))
+	int32 StarsShown = 0;
+
+	//Number of times the catalog stars were culled again and the instances rebuilt
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Stars"))
+	int64 StarFieldRebuilds = 0;
+
+	//Number of star updates that went to the GPU instead of moving the SkySphere component
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Stars"))
+	int64 StarTransformUpdatesAvoided = 0;
+
 	UPROPERTY(EditAnywhere, meta=(Category="Atmosphere"))
 	USkyAtmosphereComponent* Atmosphere;
 
+	//Curves keyed on sun elevation that drive the Sun's intensity, temperature and color and the Atmosphere's scattering.
+	//Baked into a lookup table when play starts (call BakeSkyCurves after changing them at runtime) and applied on every sun commit.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Curves"))
+	FSimpleDayNightSkyCurves SkyCurves;
+
+	//How much a curve value has to change before it's pushed to its component. Relative for values over 1, absolute below.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Curves", ClampMin="0.0"))
+	float CurveTolerance = 0.01f;
+
+	//Number of times a curve value was pushed to the Sun or Atmosphere
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Curves"))
+	int64 CurvePushes = 0;
+
+	//Sky light recaptured by the controller when ManageSkyLight is on. Hidden otherwise, so levels can keep their own.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="SkyLight"))
+	USkyLightComponent* SkyLight;
+
+	//Whether the controller's SkyLight is used, and recaptured as the sun moves instead of capturing every frame or going stale at dusk
+	UPROPERTY(EditAnywhere, Config, meta=(Category="SkyLight"))
+	bool ManageSkyLight = false;
+
+	//Degrees the sun's elevation has to change before the SkyLight is recaptured
+	UPROPERTY(EditAnywhere, Config, meta=(Category="SkyLight", ClampMin="0.0"))
+	float SkyLightElevationThreshold = 2.0f;
+
+	//How much any channel of the sunlight reaching the ground has to change before the SkyLight is recaptured
+	UPROPERTY(EditAnywhere, Config, meta=(Category="SkyLight", ClampMin="0.0"))
+	float SkyLightColorThreshold = 0.05f;
+
+	//Milliseconds a SkyLight recapture may add to its frame. The cubemap resolution is halved when captures go over and doubled when they're well under.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="SkyLight", ClampMin="0.0"))
+	float SkyLightBudget;
+
+	//Smallest cubemap resolution the budget can take the SkyLight down to
+	UPROPERTY(EditAnywhere, Config, meta=(Category="SkyLight", ClampMin="8"))
+	int32 SkyLightMinResolution = 32;
+
+	//Largest cubemap resolution the budget can take the SkyLight up to
+	UPROPERTY(EditAnywhere, Config, meta=(Category="SkyLight", ClampMin="8"))
+	int32 SkyLightMaxResolution = 256;
+
+	//Maximum number of frames a due recapture waits for a frame with headroom away from sun commits
+	UPROPERTY(EditAnywhere, Config, meta=(Category="SkyLight", ClampMin="0"))
+	int32 SkyLightMaxDeferFrames = 30;
+
+	//Number of times the SkyLight has been recaptured
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="SkyLight"))
+	int64 SkyLightRecaptures = 0;
+
+	//Milliseconds the last recapture added to its frame
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="SkyLight"))
+	float LastSkyLightCaptureCostMs = 0.0f;
+
+	//Moonlight. The second atmosphere light, moved only on sun commits once the moon has moved SunAngleThreshold degrees. Doesn't cast shadows by default.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Moon"))
+	UDirectionalLightComponent* MoonLight;
+
+	//The moon's path and phase. It's always the first body in the batch.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Moon"))
+	FSimpleDayNightSkyBody MoonBody;
+
+	//Any other planets or moons. Only drawn if something reads their parameters from SkyBodyCollection, only the moon gives light.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Moon"))
+	TArray<FSimpleDayNightSkyBody> SkyBodies;
+
+	//Collection every body's <Name>Direction (direction to the body, lit fraction in alpha) and <Name>Phase are written to on sun commits, for the sky material to draw them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Moon"))
+	UMaterialParameterCollection* SkyBodyCollection = nullptr;
+
+	//MoonLight intensity in lux at full moon, high in the sky. Scaled down by the phase and faded out as the moon sets.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Moon", ClampMin="0.0"))
+	float MoonIntensity = 0.3f;
+
 	//Latitude of the level. Positive for Northern Hemisphere, Negative for Southern
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Config)
 	float Latitude = 34;
@@ -65,8 +237,30 @@ public:
 	float AxialTilt = 23.5;
 
 	//Time of Day in hours. 24hr clock. Defaults to 6am on the day of the Winter Solstice
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float TimeOfDay = 6.0f;
+	//Mirrors the world's clock in USimpleDayNightSubsystem, which is what the sky is actually evaluated from. Writes to this are picked up on the next update.
+	//From C++ go through SetTimeOfDay, since the controller stops ticking while the clock is paused and a plain write won't wake it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetTimeOfDay)
+	double TimeOfDay = 6.0;
+
+#if WITH_EDITORONLY_DATA
+	//Scrubs the editor preview through the day. While dragging, the stars follow every step and the sun only every PreviewCommitInterval.
+	//Nothing is saved until the drag ends. Sets TimeOfDay.
+	UPROPERTY(EditAnywhere, Transient, meta=(Category="Preview", ClampMin="0.0", ClampMax="24.0", UIMin="0.0", UIMax="24.0"))
+	float PreviewHour = 6.0f;
+
+	//Scrubs the editor preview through the year, in seasons. 0 is the Northern winter solstice, 1 the spring equinox, 2 the summer solstice and 3 the autumn equinox.
+	UPROPERTY(EditAnywhere, Transient, meta=(Category="Preview", ClampMin="0.0", ClampMax="4.0", UIMin="0.0", UIMax="4.0"))
+	float PreviewSeason = 0.0f;
+
+	//Year of the editor preview
+	UPROPERTY(EditAnywhere, Transient, meta=(Category="Preview", ClampMin="0", UIMin="0", UIMax="100"))
+	int32 PreviewYear = 0;
+
+	//Seconds between sun commits while dragging TimeOfDay, Latitude, AxialTilt or a Preview slider, so levels with Virtual Shadow Maps stay interactive.
+	//The sun always lands where the drag ends.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Preview", ClampMin="0.0"))
+	float PreviewCommitInterval = 0.1f;
+#endif
 
 	//Number of real-time minutes for 24 hours in-game
 	UPROPERTY(EditAnywhere, Config)
@@ -85,15 +279,249 @@ public:
 	UPROPERTY(EditAnywhere, Config)
 	bool SmoothTime;
 
+	//Whether to only commit the sun position once it has moved more than SunAngleThreshold degrees since the last commit.
+	//Overrides SmoothTime. The sun direction is still recomputed every frame, but VSM rebuilds scale with the length of the day instead of the framerate.
+	UPROPERTY(EditAnywhere, Config)
+	bool ThresholdUpdate;
+
+	//How many degrees the sun has to move before its position is committed when using threshold sun updates
+	UPROPERTY(EditAnywhere, Config, meta=(ClampMin="0.0"))
+	float SunAngleThreshold;
+
+	//Whether stepped and threshold sun updates wait for a frame with headroom before committing, rather than committing on whichever frame they come due.
+	//Never commits on two frames in a row, which smooths out the frame pacing hitches from VSM rebuilds.
+	UPROPERTY(EditAnywhere, Config)
+	bool CommitScheduler;
+
+	//Maximum number of frames a due sun update can be held back while waiting for a frame with headroom
+	UPROPERTY(EditAnywhere, Config, meta=(ClampMin="0"))
+	int32 MaxDeferFrames;
+
+	//Maximum number of degrees the displayed sun may lag behind its real position before a held back update is forced
+	UPROPERTY(EditAnywhere, Config, meta=(ClampMin="0.0"))
+	float MaxLagAngle;
+
+	//Number of keyframes per in-game day in the orientation cache. The sun and star rotations are slerped between keys instead of being rebuilt every update.
+	//More keys are more accurate but use more memory. 0 disables the cache.
+	UPROPERTY(EditAnywhere, Config, meta=(ClampMin="0"))
+	int32 OrientationCacheKeys;
+
+	//Seconds between clock updates. Events fire and snapshots are published at this rate, the sun and stars are still drawn for the exact time every frame.
+	//0 updates the clock every frame.
+	UPROPERTY(EditAnywhere, Config, meta=(ClampMin="0.0"))
+	float ClockTickInterval;
+
+	//Most pixels the sky may move across the screen between ticks of this controller. It ticks only as often as that needs, worked out
+	//from how fast the sky is turning, the camera's field of view and the viewport width, and stops ticking while the clock is stopped.
+	//0 ticks every frame.
+	UPROPERTY(EditAnywhere, Config, meta=(ClampMin="0.0"))
+	float TickPixelThreshold;
+
+	//Longest this controller goes between ticks while the clock is running, so replication, latitude regions and the SkyLight keep up
+	UPROPERTY(EditAnywhere, Config, meta=(ClampMin="0.0"))
+	float MaxTickInterval = 0.25f;
+
+	//Sun commits per second while a timed warp sweeps the sky, with the stars moved alongside. Both always land together when the warp does.
+	//0 only commits when the warp lands.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Sun", ClampMin="0.0"))
+	float WarpCommitRate = 2.0f;
+
+	//Seconds between clock updates sent to clients when nothing else has changed. Clients extrapolate in between.
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Replication", ClampMin="1.0"))
+	float ClockHeartbeatInterval = 60.0f;
+
+	//Seconds a client takes to smoothly close the gap to the server's clock
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Replication", ClampMin="0.0"))
+	float ClockCorrectionTime = 2.0f;
+
+	//In-game hours a client can be off from the server's clock before it snaps instead of correcting smoothly
+	UPROPERTY(EditAnywhere, Config, meta=(Category="Replication", ClampMin="0.0"))
+	float ClockSnapHours = 1.0f;
+
+	//Number of clock updates the server has sent
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Replication"))
+	int64 ClockUpdatesSent = 0;
+
+	//Bytes of clock state the server has sent, not counting property and packet headers
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Replication"))
+	int64 ClockBytesSent = 0;
+
+	//How far behind the server's clock this client was on the last frame, in in-game hours
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Replication"))
+	double ClockErrorHours = 0.0;
+
+	//Fires at every sunrise, sunset, noon, midnight, solstice and equinox. Use BindCelestialEvent to be told ahead of or after an event.
+	//The world's USimpleDayNightSubsystem has the same event, for when there's no controller to hand.
+	UPROPERTY(BlueprintAssignable, meta=(Category="Events"))
+	FOnCelestialEventSignature OnCelestialEvent;
+
+	//Number of times the sun position has been committed to the Axis and Sun components
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Sun"))
+	int64 SunCommits = 0;
+
+	//Number of frames on which threshold update skipped committing the sun position
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Sun"))
+	int64 SkippedSunCommits = 0;
+
+	//Sun commits over the last second of real time
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Sun"))
+	float SunCommitsPerSecond = 0.0f;
+
+	//Degrees the sun moved on the last commit
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Sun"))
+	float LastSunStepDegrees = 0.0f;
+
+	//Number of times this controller has ticked
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Tick"))
+	int64 ControllerTicks = 0;
+
+	//Number of frames this controller didn't tick on because of TickPixelThreshold or a stopped clock
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Tick"))
+	int64 TicksSaved = 0;
+
+	//Ticks over the last second of real time. 0 while idle.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, meta=(Category="Tick"))
+	float TicksPerSecond = 0.0f;
+
 protected:
 	FTimerHandle SteppedTimerHandle;
 
+	//The time the sky is drawn for. Copied from the world's subsystem every tick, and only kept here for the editor and before play starts.
+	//Whole days are kept apart from the hour so precision doesn't drop over long uptimes.
+	FSimpleDayNightTime Clock = FSimpleDayNightTime::FromHours(6.0);
+
+	//Value of TimeOfDay when it was last written from the clock, to notice when something else changes it
+	double ClockTimeOfDay = 6.0;
+
+	//Sun direction at the last commit, used by threshold update
+	FVector LastCommittedSunDirection = FVector::ZeroVector;
+
+	//Moon direction the MoonLight was last turned to
+	FVector LastMoonLightDirection = FVector::ZeroVector;
+
+	//Set when there's nothing to draw the sky for, so only the clock is kept
+	bool bHeadless = false;
+
+	//The server's clock epoch and rate. Only sent when they change or the heartbeat is due.
+	UPROPERTY(ReplicatedUsing=OnRep_ReplicatedClock)
+	FSimpleDayNightReplicatedClock ReplicatedClock;
+
+	//Handles of the OnChanged subscriptions to the sdn.* CVars, in the same order as the CVars
+	TArray<FDelegateHandle> LinkedCVarHandles;
+
+	//Handles of the subsystem's event scheduler subscriptions that fire OnCelestialEvent
+	TArray<FDelegateHandle> CelestialEventHandles;
+
+	//Clock generation last sent, so clients get a new epoch straight away when the clock jumps
+	uint32 ReplicatedClockGeneration = 0;
+
+	//Warp serial of the last warp played back on this client
+	uint8 ReplicatedWarpSerial = 0;
+
+	//Set on clients once the first epoch has arrived
+	bool bReceivedClock = false;
+
+	//Epoch of the last clock update a client corrected towards, so each one is only applied once
+	double CorrectedEpochServerTime = -1.0;
+
+	//Handle of the subscription to the subsystem's OnWarp
+	FDelegateHandle WarpHandle;
+
+	//World time of the last sun commit during a timed warp
+	double LastWarpCommitTime = 0.0;
+
+	//Set while a drag in the editor is moving through days or changing the sky params, so the preview evaluates directly instead of rebuilding the orientation cache every step
+	bool bScrubbing = false;
+
+#if WITH_EDITORONLY_DATA
+	//Real time of the last sun commit during a drag in the editor
+	double LastPreviewCommitTime = 0.0;
+
+	//Set while a drag step reruns the construction script, which would otherwise commit the sun and rebake the curves on every step
+	bool bEditorDragging = false;
+#endif
+
+	//Settings as last pushed to the subsystem. Only changes are pushed, so changes made straight to the subsystem stick.
+	FSimpleDayNightEphemerisParams PushedParams;
+	float PushedLengthOfDay = 0.0f;
+	float PushedClockTickInterval = 0.0f;
+
+	//World time replication started at, for GetClockBytesPerMinute
+	double ReplicationStartTime = 0.0;
+
+	//Real time, SunCommits and ControllerTicks at the start of the current SunCommitsPerSecond and TicksPerSecond window
+	double CommitRateWindowStart = 0.0;
+	int64 CommitRateWindowCommits = 0;
+	int64 CommitRateWindowTicks = 0;
+
+	//Engine frame of the last tick, to count the ones in between as saved
+	uint64 LastTickFrame = 0;
+
+	//Handle of the subscription to the subsystem's OnClockChanged
+	FDelegateHandle ClockChangedHandle;
+
+	//In flight load of SkySphereMesh and SkySphereMaterial
+	TSharedPtr<FStreamableHandle> SkySphereLoadHandle;
+
+	//Picks the frames that stepped and threshold sun updates are committed on
+	FSimpleDayNightCommitScheduler SunCommitScheduler;
+
+	//SkyCurves baked by BakeSkyCurves
+	FSimpleDayNightCurveTable SkyCurveTable;
+
+	//Curve values as last pushed to the components, by FSimpleDayNightCurveTable channel
+	float PushedCurveValues[FSimpleDayNightCurveTable::NumChannels] = {};
+	bool bCurvesPushed = false;
+
+	//Picks when and at what resolution the SkyLight is recaptured
+	FSimpleDayNightSkyLightScheduler SkyLightScheduler;
+
+	//Keyframed sky orientations for the current day
+	FSimpleDayNightOrientationCache OrientationCache;
+
+	//MoonBody then SkyBodies, as of the last sun commit
+	FSimpleDayNightBodyBatch SkyBodyBatch;
+
+	//A body's Name and the <Name>Direction and <Name>Phase parameters made from it
+	struct FSkyBodyParameterNames
+	{
+		FName Body;
+		FName Direction;
+		FName Phase;
+	};
+
+	//For MoonBody then SkyBodies, so sun commits don't build strings and look up names
+	TArray<FSkyBodyParameterNames> SkyBodyParameterNames;
+
+	//Mapped StarCatalogFile
+	FSimpleDayNightStarCatalog StarCatalog;
+
+	//What the star field instances were last built for
+	TArray<int32> StarFieldIndices;
+	float BuiltStarMagnitudeLimit = 0.0f;
+	FVector3f BuiltStarViewDirection = FVector3f::ZeroVector;
+	float BuiltStarViewAngle = 0.0f;
+	bool bStarFieldBuilt = false;
+
+	//Where the local view was this frame, for blending latitude regions. Only set while the world has any.
+	FVector ViewLocation = FVector::ZeroVector;
+	bool bHasViewLocation = false;
+
+	void UpdateViewLocation(const USimpleDayNightSubsystem* DayNight);
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	//Sets PreviewHour, PreviewSeason and PreviewYear from the clock
+	void UpdatePreviewFromClock();
 #endif	
 
 public:	
@@ -106,8 +534,155 @@ public:
 
 	void UpdateSunPositionTimer();
 
+	//Commits the sun position only if it has moved more than SunAngleThreshold since the last commit
+	void UpdateSunPositionThreshold();
+
+	//Direction the sunlight travels at the current time, without touching any components. Works in headless mode too.
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	FVector GetSunDirection() const;
+
+	//Elevation of the sun above the horizon in degrees at the current time. Works in headless mode too.
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	double GetSunElevation() const;
+
+	//Average bytes per minute of clock state sent by the server since play started
+	UFUNCTION(BlueprintPure, meta=(Category="Replication"))
+	float GetClockBytesPerMinute() const;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//Calls Delegate OffsetHours in-game hours after every Event. Use a negative offset for before, e.g. -0.5 and Sunset for half an hour before sunset.
+	UFUNCTION(BlueprintCallable, meta=(Category="Events"))
+	void BindCelestialEvent(ECelestialEvent Event, float OffsetHours, FCelestialEventDelegate Delegate);
+
+	//Removes every binding of Delegate made with BindCelestialEvent
+	UFUNCTION(BlueprintCallable, meta=(Category="Events"))
+	void UnbindCelestialEvent(FCelestialEventDelegate Delegate);
+
+	//In-game hours until the next Event, or -1 if it doesn't happen within a year (like sunrise in polar night)
+	UFUNCTION(BlueprintPure, meta=(Category="Events"))
+	double GetHoursUntilCelestialEvent(ECelestialEvent Event) const;
+
+	//The world's clock. Null for the class default object and worlds without subsystems.
+	USimpleDayNightSubsystem* GetDayNightSubsystem() const;
+
+	//Whether this controller is only keeping time, without any visual components (dedicated servers and -nullrhi)
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	bool IsHeadless() const { return bHeadless; }
+
+	//Whether controllers should create their Sun, SkySphere and Atmosphere. False for dedicated servers and -nullrhi,
+	//unless -SimpleDayNightVisuals is on the command line. Always true in the editor so the components are saved with levels and Blueprints.
+	static bool ShouldCreateVisualComponents();
+
+	FSimpleDayNightEphemerisParams GetEphemerisParams() const;
+
+	//Sky orientation for the current time, from the orientation cache if it's enabled, blended with any latitude regions around the local view
+	FSimpleDayNightOrientation GetOrientation();
+
+	//Direction the moonlight travels as of the last sun commit
+	UFUNCTION(BlueprintPure, meta=(Category="Moon"))
+	FVector GetMoonDirection() const { return GetSkyBodyDirection(0); }
+
+	//Lit fraction of the moon's disc as of the last sun commit. 0 is new, 1 is full.
+	UFUNCTION(BlueprintPure, meta=(Category="Moon"))
+	float GetMoonIllumination() const { return SkyBodyBatch.Illumination.Num() > 0 ? SkyBodyBatch.Illumination[0] : 0.0f; }
+
+	//Direction the light of a body travels as of the last sun commit. 0 is the moon, SkyBodies start at 1.
+	UFUNCTION(BlueprintPure, meta=(Category="Moon"))
+	FVector GetSkyBodyDirection(int32 Index) const;
+
+	//Latitude the sky is drawn for, blended with any latitude regions around the local view
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	float GetViewLatitude() const;
+
+	//Bakes SkyCurves into the lookup table the Sun and Atmosphere are driven from
+	UFUNCTION(BlueprintCallable, meta=(Category="Curves"))
+	void BakeSkyCurves();
+
+	//Throws away the cached orientations. Only needed if the sky math changes under the cache, changes to Latitude, AxialTilt and SeasonLength are picked up automatically.
+	UFUNCTION(BlueprintCallable, meta=(Category="Sun"))
+	void InvalidateOrientationCache();
+
+	const FSimpleDayNightTime& GetClock() const { return Clock; }
+
+	//Frame time in seconds at the given percentile (0-100) of the recent frame history kept by the commit scheduler
+	UFUNCTION(BlueprintCallable, meta=(Category="Sun"))
+	float GetFrameTimePercentile(float Percentile) const;
+
+	const FSimpleDayNightCommitScheduler& GetSunCommitScheduler() const { return SunCommitScheduler; }
+
 	void UpdateStarPosition();
 
+	UFUNCTION(BlueprintSetter)
+	void SetTimeOfDay(double InTimeOfDay);
+
+	//Starts ticking again at once if the controller was idle or ticking slowly, so a change shows on the next frame
+	void WakeTick();
+
+	//Applies a change to one of the sdn.* CVars to the linked property and queues it to be saved
+	void OnLinkedCVarChanged(IConsoleVariable* Variable, FName PropertyName);
+
+	//Queues the current value of one Config property to be saved with FSimpleDayNightConfigWriter.
+	//In the editor that's DefaultSimpleDayNight.ini, in a build the local SimpleDayNight.ini through GConfig.
+	void QueueConfigSave(FName PropertyName);
+
+protected:
+	//Updates SunCommitsPerSecond and TicksPerSecond and reports them and LastSunStepDegrees to stats and the CSV profiler
+	void UpdateCommitRate();
+
+	//Sets the tick interval so the sky moves at most TickPixelThreshold pixels between ticks, or turns the tick off while the clock is stopped
+	//and nothing follows the camera
+	void UpdateTickInterval(const USimpleDayNightSubsystem* DayNight);
+
+	//Starts loading SkySphereMesh and SkySphereMaterial if the SkySphere doesn't have them yet
+	void RequestSkySphereLoad();
+
+	//Puts the loaded mesh and material on the SkySphere
+	void OnSkySphereLoaded();
+
+	//Maps StarCatalogFile if there is one
+	void LoadStarCatalog();
+
+	//Culls the catalog to StarMagnitudeLimit and the view, and rebuilds the StarField's instances if that changed what's kept
+	void UpdateStarField();
+
+	//Samples the curve table at the current sun elevation and season and pushes the values that changed beyond CurveTolerance
+	void ApplySkyCurves();
+
+	//Evaluates every body in one batch and moves the MoonLight and SkyBodyCollection to match. Called on every sun commit.
+	void UpdateSkyBodies();
+
+	//Makes SkyBodyParameterNames match MoonBody and SkyBodies. Only builds names for bodies that were added or renamed.
+	void UpdateSkyBodyParameterNames();
+
+	//Whether the SkyLight is in use and should be recaptured
+	bool IsSkyLightManaged() const;
+
+	//Recaptures the SkyLight if a recapture is due and this is a good frame for it. Called at the end of every tick.
+	void UpdateSkyLight();
+
+	//Starts or stops the stepped update timer to match SmoothTime and ThresholdUpdate
+	void RefreshSteppedTimer();
+
+	//Resets the clock if TimeOfDay has been changed from the editor or Blueprint since the clock last wrote it.
+	//Also sets the subsystem's clock if this is the primary controller.
+	void SyncClock();
+
+	//Sends Latitude, AxialTilt, LengthOfDay, SeasonLength and ClockTickInterval to the subsystem if they changed since the last push
+	void PushSettings(USimpleDayNightSubsystem& DayNight);
+
+	//Server world time that clocks are replicated against
+	double GetServerTime() const;
+
+	//On the server, sends a new epoch if the rate or time changed or the heartbeat is due.
+	//On clients, steers the subsystem's clock towards the server's once per update.
+	void UpdateClockReplication(USimpleDayNightSubsystem& DayNight);
+
 	UFUNCTION()
-	void SmoothSinkFunction();
+	void OnRep_ReplicatedClock();
+
+	//Commits the sun and stars once when a warp lands, and starts the capped commit rate when a timed one starts
+	void OnClockWarp(bool bFinished);
+
+	void BroadcastCelestialEvent(ECelestialEvent Event, double OffsetHours);
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SimpleDayNightBenchmarkCommandlet.generated.h"
+
+class FJsonObject;
+
+/**
+ * Times the sky math, loading and culling a star catalog, the controller updates with 1, 10 and 1000 controllers, and simulated multi-day runs at a few
+ * Length of Day and Length of Seasons settings, and writes the results to JSON for regression tracking.
+ * Doesn't need the editor or a GPU:
+ *
+ *   UnrealEditor-Cmd <Project> -run=SimpleDayNightBenchmark -nullrhi -unattended [-SimpleDayNightVisuals] [-Output=<file>] [-Days=<n>]
+ *
+ * Without -SimpleDayNightVisuals (or a GPU) the controllers are headless, so the component update numbers only cover the clock.
+ */
+UCLASS()
+class USimpleDayNightBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USimpleDayNightBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	//Nanoseconds per call of the ephemeris, orientation cache and event scheduler
+	TSharedRef<FJsonObject> RunMathBenchmarks() const;
+
+	//Load time of a generated catalog, mapped and read in, and the cost of culling it by magnitude and view
+	TSharedRef<FJsonObject> RunStarCatalogBenchmark() const;
+
+	//Frame and per-controller update cost with NumControllers controllers in a game world
+	TSharedRef<FJsonObject> RunControllerBenchmark(int32 NumControllers) const;
+
+	//Runs the clock, events and threshold and stepped update policies at 60fps for Days in-game days
+	TSharedRef<FJsonObject> RunSimulation(float LengthOfDay, float SeasonLength, int32 Days) const;
+};
@@ -0,0 +1,92 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Picks the frame on which a due sun commit actually happens.
+ * Keeps a rolling history of frame times and holds a due commit back until a frame with headroom turns up,
+ * never commits on two consecutive frames, and forces the commit once it has waited too long.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightCommitScheduler
+{
+public:
+	FSimpleDayNightCommitScheduler(int32 InHistorySize = 600);
+
+	//Records the duration of the frame that just finished. Call once per frame before ShouldCommit.
+	void AddFrameTime(float DeltaTime);
+
+	//Marks a sun commit as due. It happens on the next frame ShouldCommit returns true.
+	void RequestCommit();
+
+	bool IsCommitPending() const { return bCommitPending; }
+
+	//Whether the pending commit should happen on this frame.
+	//bDeadline forces the commit on the first frame that doesn't directly follow another commit.
+	bool ShouldCommit(int32 MaxDeferFrames, bool bDeadline);
+
+	//Call whenever the sun position is committed, scheduled or not
+	void NotifyCommitted();
+
+	//Duration of the frame recorded by the last AddFrameTime
+	float GetLastFrameTime() const;
+
+	//Number of frames recorded so far
+	uint64 GetFrameNumber() const { return FrameNumber; }
+
+	//Frame time in seconds at the given percentile (0-100) of the rolling history. Sorts a copy of it, so not for every frame.
+	float GetFrameTimePercentile(float Percentile) const;
+
+	//Median frame time in seconds, only worked out again every few frames. Cheap enough for every frame.
+	float GetMedianFrameTime() const;
+
+	//Number of commits that were held back for at least one frame
+	int64 GetDeferredCommits() const { return DeferredCommits; }
+
+	//Number of commits forced by the deadline rather than made on a frame with headroom
+	int64 GetForcedCommits() const { return ForcedCommits; }
+
+	//Total number of frames commits were held back for
+	int64 GetDeferredFrames() const { return DeferredFrames; }
+
+private:
+	bool HasHeadroom();
+
+	TArray<float> FrameTimes;
+	int32 NextFrameTime = 0;
+	int32 NumFrameTimes = 0;
+
+	//Median frame time, refreshed every few frames when something asks for it
+	mutable float HeadroomBudget = 0.0f;
+	mutable uint64 HeadroomBudgetFrame = 0;
+
+	uint64 FrameNumber = 0;
+	uint64 LastCommitFrame = 0;
+	int32 PendingFrames = 0;
+	bool bCommitPending = false;
+
+	int64 DeferredCommits = 0;
+	int64 ForcedCommits = 0;
+	int64 DeferredFrames = 0;
+};
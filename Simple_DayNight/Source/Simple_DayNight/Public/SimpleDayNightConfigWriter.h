@@ -0,0 +1,69 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+/**
+ * Writes changed config values to disk once nothing has changed for SaveDelay seconds. Values are coalesced per key, so a
+ * scalability preset that flips a dozen CVars costs one write instead of a dozen. Writes happen on the game thread, like the
+ * project settings panel's and GConfig's own, so none of them can land on top of another.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightConfigWriter
+{
+public:
+	//Seconds to wait after the last change before writing
+	static constexpr float SaveDelay = 1.0f;
+
+	//Game thread. Queues Key=Value in Section of an ini GConfig doesn't hold (like DefaultSimpleDayNight.ini) and pushes the write back by SaveDelay seconds.
+	void SetValue(const FString& Filename, const FString& Section, const FString& Key, const FString& Value);
+
+	//Game thread. Flushes a GConfig file whose values were already set with GConfig->SetString, SaveDelay seconds after the last change.
+	void QueueFlush(const FString& ConfigFilename);
+
+	//Game thread. Writes everything queued straight away. Called when the module shuts down.
+	void Flush();
+
+	//Number of ini files written since startup
+	int32 GetNumWrites() const { return NumWrites; }
+
+	//The writer the DayNightControllers queue their settings with
+	static FSimpleDayNightConfigWriter& Get();
+
+private:
+	bool Tick(float DeltaTime);
+
+	//Debounce. Every change restarts the wait.
+	void RestartDelay();
+
+	//Filename -> Section -> Key -> Value
+	TMap<FString, TMap<FString, TMap<FString, FString>>> Pending;
+
+	//GConfig files to flush
+	TSet<FString> PendingFlushes;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	int32 NumWrites = 0;
+};
@@ -0,0 +1,111 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimpleDayNightCurveTable.generated.h"
+
+class UCurveFloat;
+class UCurveLinearColor;
+
+/** Authored curves that drive the Sun and Atmosphere from the sun's elevation in degrees (-90 to 90) */
+USTRUCT(BlueprintType)
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightSkyCurves
+{
+	GENERATED_BODY()
+
+	//Sun intensity in lux by sun elevation
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Sun"))
+	UCurveFloat* SunIntensity = nullptr;
+
+	//Sun color temperature in kelvin by sun elevation. Turns on the Sun's Use Temperature.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Sun"))
+	UCurveFloat* SunTemperature = nullptr;
+
+	//Sun light color by sun elevation
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Sun"))
+	UCurveLinearColor* SunColor = nullptr;
+
+	//Atmosphere Rayleigh scattering scale by sun elevation
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Atmosphere"))
+	UCurveFloat* RayleighScatteringScale = nullptr;
+
+	//Atmosphere Mie scattering scale by sun elevation
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Atmosphere"))
+	UCurveFloat* MieScatteringScale = nullptr;
+
+	//Atmosphere sky luminance factor by sun elevation
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Atmosphere"))
+	UCurveLinearColor* SkyLuminanceFactor = nullptr;
+
+	//Multiplies the sun intensity and sky luminance by the position in the local year, 0 to 1 from the local winter solstice.
+	//Leave empty for no seasonal change.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Season"))
+	UCurveFloat* SeasonScale = nullptr;
+};
+
+/**
+ * The sky curves baked into a flat table of elevation samples (and season samples, if there's a season curve), so the
+ * controller does one interpolated lookup per update instead of evaluating every curve.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightCurveTable
+{
+public:
+	enum EChannel
+	{
+		SunIntensity,
+		SunTemperature,
+		SunColorR,
+		SunColorG,
+		SunColorB,
+		RayleighScatteringScale,
+		MieScatteringScale,
+		SkyLuminanceR,
+		SkyLuminanceG,
+		SkyLuminanceB,
+		NumChannels
+	};
+
+	//Samples every curve in Curves ElevationSamples times from -90 to 90 degrees, and SeasonSamples times over the year if there's a season curve
+	void Bake(const FSimpleDayNightSkyCurves& Curves, int32 ElevationSamples = 181, int32 SeasonSamples = 16);
+
+	void Reset();
+
+	bool IsEmpty() const { return ChannelMask == 0; }
+
+	bool HasChannel(EChannel Channel) const { return (ChannelMask & (1u << Channel)) != 0; }
+
+	//Fills OutValues (NumChannels long) with every channel at the given elevation and season phase in [0, 1). Channels without a curve are left alone.
+	void Sample(double Elevation, double SeasonPhase, float* OutValues) const;
+
+	//Bytes used by the samples
+	SIZE_T GetAllocatedSize() const { return Values.GetAllocatedSize(); }
+
+private:
+	//Samples laid out season by season, elevation by elevation, channel by channel
+	TArray<float> Values;
+
+	uint32 ChannelMask = 0;
+	int32 NumElevations = 0;
+	int32 NumSeasons = 0;
+};
@@ -0,0 +1,215 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A point in in-game time, split into a whole number of days and the hour within that day.
+ * Keeping the day count separate means the hour never loses precision, no matter how long the clock has been running.
+ */
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightTime
+{
+	//Whole in-game days since the clock started. Day 0 starts at midnight before the Northern Winter Solstice.
+	int64 Day = 0;
+
+	//Hour within the day, in [0, 24)
+	double Hour = 0.0;
+
+	FSimpleDayNightTime() = default;
+
+	FSimpleDayNightTime(int64 InDay, double InHour)
+		: Day(InDay)
+		, Hour(InHour)
+	{
+		Normalize();
+	}
+
+	//Converts a total number of hours (like ADayNightController::TimeOfDay) into a day and an hour
+	static FSimpleDayNightTime FromHours(double Hours);
+
+	//Total number of hours since the clock started. Loses precision for very large day counts, so prefer keeping the split form.
+	double ToHours() const;
+
+	void AddHours(double Hours);
+
+	//Moves whole days out of Hour and into Day
+	void Normalize();
+
+	//Number of hours from Other to this time
+	double HoursSince(const FSimpleDayNightTime& Other) const;
+
+	bool operator==(const FSimpleDayNightTime& Other) const { return Day == Other.Day && Hour == Other.Hour; }
+	bool operator!=(const FSimpleDayNightTime& Other) const { return !(*this == Other); }
+	bool operator<(const FSimpleDayNightTime& Other) const { return Day < Other.Day || (Day == Other.Day && Hour < Other.Hour); }
+};
+
+/** The planet and location parameters the sky orientation depends on */
+struct FSimpleDayNightEphemerisParams
+{
+	//Latitude in degrees. Positive for Northern Hemisphere, Negative for Southern
+	double Latitude = 34.0;
+
+	//Tilt of the planet's axis off the ecliptic in degrees
+	double AxialTilt = 23.5;
+
+	//Number of in-game days a season lasts
+	double SeasonLength = 5.0;
+
+	bool operator==(const FSimpleDayNightEphemerisParams& Other) const
+	{
+		return Latitude == Other.Latitude && AxialTilt == Other.AxialTilt && SeasonLength == Other.SeasonLength;
+	}
+	bool operator!=(const FSimpleDayNightEphemerisParams& Other) const { return !(*this == Other); }
+};
+
+/** Everything the controller needs to place the sun and stars at one point in time */
+struct FSimpleDayNightOrientation
+{
+	//World rotation of the Axis component the Sun is attached to
+	FQuat Axis = FQuat::Identity;
+
+	//Relative rotation of the Sun, the seasonal wobble
+	FQuat SunRelative = FQuat::Identity;
+
+	//World rotation of the star sphere
+	FQuat Stars = FQuat::Identity;
+
+	//Direction the sunlight travels
+	FVector SunDirection = FVector::ZeroVector;
+
+	//Elevation of the sun above the horizon in degrees
+	double SunElevation = 0.0;
+};
+
+/**
+ * Structure of arrays batch of sky samples for FSimpleDayNightEphemeris::EvaluateBatch.
+ * Fill in the inputs with Add or by setting the input arrays directly, the outputs are sized by EvaluateBatch.
+ */
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightEphemerisBatch
+{
+	//Inputs
+	TArray<int64> Days;
+	TArray<double> Hours;
+	TArray<float> Latitudes;
+
+	//Outputs. Direction the sunlight travels and the sun's elevation in degrees.
+	TArray<float> SunDirectionX;
+	TArray<float> SunDirectionY;
+	TArray<float> SunDirectionZ;
+	TArray<float> SunElevation;
+
+	//Outputs. Star sphere rotation quaternion.
+	TArray<float> StarRotationX;
+	TArray<float> StarRotationY;
+	TArray<float> StarRotationZ;
+	TArray<float> StarRotationW;
+
+	void Add(const FSimpleDayNightTime& Time, float Latitude);
+
+	void Reset();
+
+	int32 Num() const { return Days.Num(); }
+};
+
+/** Path of a body other than the sun (a moon or a planet), relative to the sun's */
+struct FSimpleDayNightBodyOrbit
+{
+	//In-game days for the body to lap the sun and come back to the same phase. The Moon is 29.5. 0 keeps it at PhaseOffset forever.
+	double SynodicPeriod = 29.5;
+
+	//Phase on day 0 in [0, 1). 0 is alongside the sun (new moon), 0.5 is opposite it (full moon).
+	double PhaseOffset = 0.0;
+
+	//Degrees the body's path is tilted off the sun's. The Moon is about 5.
+	double Inclination = 5.0;
+};
+
+/**
+ * Structure of arrays batch of bodies for FSimpleDayNightEphemeris::EvaluateBodies, all evaluated at the same time and latitude.
+ * Fill in the inputs with Add, the outputs are sized by EvaluateBodies.
+ */
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightBodyBatch
+{
+	//Inputs
+	TArray<double> SynodicPeriods;
+	TArray<double> PhaseOffsets;
+	TArray<float> Inclinations;
+
+	//Outputs. Direction the body's light travels and its elevation in degrees.
+	TArray<float> DirectionX;
+	TArray<float> DirectionY;
+	TArray<float> DirectionZ;
+	TArray<float> Elevation;
+
+	//Outputs. Phase in [0, 1) and the lit fraction of the disc (0 new, 1 full).
+	TArray<float> Phase;
+	TArray<float> Illumination;
+
+	void Add(const FSimpleDayNightBodyOrbit& Orbit);
+
+	void Reset();
+
+	int32 Num() const { return SynodicPeriods.Num(); }
+};
+
+/**
+ * The celestial math behind the day/night cycle, with no dependency on any UObject.
+ * (Still treating the orbit as a perfect circle, because that's good enough for video games.)
+ */
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightEphemeris
+{
+	//Position in the year in [0, 1). 0 is noon on the Northern Winter Solstice, 0.5 is noon on the Northern Summer Solstice.
+	static double GetSeasonPhase(const FSimpleDayNightTime& Time, double SeasonLength);
+
+	//Pitch of the Sun relative to the Axis in degrees. Wobbles by AxialTilt over the year to fake seasons.
+	static double GetSunPitch(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	static FQuat GetAxisRotation(const FSimpleDayNightTime& Time, double Latitude);
+
+	static FQuat GetSunRelativeRotation(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	static FQuat GetStarRotation(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	//Direction the sunlight travels. Same as the Sun component's forward vector, without building any rotations.
+	static FVector GetSunDirection(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	//Elevation of the sun above the horizon in degrees
+	static double GetSunElevation(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	static FSimpleDayNightOrientation Evaluate(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	//Evaluates sun direction, sun elevation and star rotation for every sample in the batch, four at a time using SIMD.
+	//Latitude comes from each sample, AxialTilt and SeasonLength are shared by the whole batch.
+	static void EvaluateBatch(FSimpleDayNightEphemerisBatch& Batch, double AxialTilt, double SeasonLength);
+
+	//Phase of a body in [0, 1), how far it has fallen behind the sun since they were last together
+	static double GetBodyPhase(const FSimpleDayNightTime& Time, const FSimpleDayNightBodyOrbit& Orbit);
+
+	//Direction the body's light travels. A body at phase p rises p of a day after the sun, and follows the sun's seasonal wobble
+	//from where the sun will be p of a year later, plus its own Inclination.
+	static FVector GetBodyDirection(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params, const FSimpleDayNightBodyOrbit& Orbit);
+
+	//Evaluates direction, elevation, phase and illumination for every body in the batch, four at a time using SIMD
+	static void EvaluateBodies(FSimpleDayNightBodyBatch& Batch, const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+};
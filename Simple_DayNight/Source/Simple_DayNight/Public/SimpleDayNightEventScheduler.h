@@ -0,0 +1,139 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/EnumRange.h"
+#include "SimpleDayNightEphemeris.h"
+#include "SimpleDayNightEventScheduler.generated.h"
+
+//Points in the day and year the event scheduler can fire delegates for
+UENUM(BlueprintType)
+enum class ECelestialEvent : uint8
+{
+	Sunrise,
+	Sunset,
+	Noon,
+	Midnight,
+	WinterSolstice,
+	SpringEquinox,
+	SummerSolstice,
+	AutumnEquinox
+};
+ENUM_RANGE_BY_FIRST_AND_LAST(ECelestialEvent, ECelestialEvent::Sunrise, ECelestialEvent::AutumnEquinox);
+
+/**
+ * Works out when sunrise, sunset, noon, midnight, solstices and equinoxes happen from the ephemeris params
+ * and fires delegates as the clock passes them. Upcoming events wait in a priority queue, so the cost is
+ * O(log n) per event that actually happens instead of polling every frame.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightEventScheduler
+{
+public:
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnCelestialEvent, ECelestialEvent /*Event*/, double /*OffsetHours*/);
+
+	//Calls Delegate OffsetHours in-game hours after every Event. Use a negative offset for before, e.g. -0.5 and Sunset for half an hour before sunset.
+	FDelegateHandle Register(ECelestialEvent Event, double OffsetHours, FOnCelestialEvent::FDelegate Delegate);
+
+	void Unregister(FDelegateHandle Handle);
+
+	//Fires every event between the last time and Time in order. Params changes, the clock going backwards, or jumps longer than
+	//MaxCatchUpHours reschedule everything from Time without firing anything.
+	void AdvanceTo(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	//Forgets the queue. The next AdvanceTo schedules everything from its time without firing.
+	void Reset();
+
+	//Time of the next occurrence of Event, including its offset, for the subscription registered with Handle
+	bool GetScheduledTime(FDelegateHandle Handle, FSimpleDayNightTime& OutTime) const;
+
+	void SetMaxCatchUpHours(double InMaxCatchUpHours) { MaxCatchUpHours = InMaxCatchUpHours; }
+
+	double GetMaxCatchUpHours() const { return MaxCatchUpHours; }
+
+	//Until EndCollapse, events that come due are held back instead of firing
+	void BeginCollapse();
+
+	//Fires each subscription held back since BeginCollapse once, in the order of its last occurrence
+	void EndCollapse();
+
+	bool IsCollapsing() const { return bCollapsing; }
+
+	int32 GetNumQueued() const { return Queue.Num(); }
+
+	//First occurrence of Event strictly after After. False if it doesn't happen within a year, like sunrise in polar night.
+	static bool FindNextEvent(ECelestialEvent Event, const FSimpleDayNightTime& After, const FSimpleDayNightEphemerisParams& Params, FSimpleDayNightTime& OutTime);
+
+	//Sunrise or sunset on the given day. False if the sun doesn't cross the horizon that day.
+	static bool FindSunCrossing(bool bSunrise, int64 Day, const FSimpleDayNightEphemerisParams& Params, FSimpleDayNightTime& OutTime);
+
+private:
+	struct FSubscription
+	{
+		ECelestialEvent Event;
+		double OffsetHours;
+		FOnCelestialEvent Delegate;
+		uint32 Serial;
+	};
+
+	struct FScheduledEvent
+	{
+		//When it fires, including the offset
+		FSimpleDayNightTime Time;
+
+		//When the event itself happens. The next one is searched for strictly after this, not after Time minus the offset,
+		//which can round back onto the same event and fire it again.
+		FSimpleDayNightTime EventTime;
+
+		int32 Subscription;
+		uint32 Serial;
+
+		//Set when the event wasn't found within a year. Popping it only searches again, it doesn't fire.
+		bool bRecheck;
+	};
+
+	//Queues the first occurrence of the subscription's event that fires strictly after From
+	void Schedule(int32 SubscriptionIndex, const FSimpleDayNightTime& From);
+
+	//Queues the first occurrence of the event strictly after SearchAfter that also fires strictly after From
+	void Schedule(int32 SubscriptionIndex, const FSimpleDayNightTime& From, const FSimpleDayNightTime& SearchAfter);
+
+	void Reschedule(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	TSparseArray<FSubscription> Subscriptions;
+	TMap<FDelegateHandle, int32> HandleToSubscription;
+	TArray<FScheduledEvent> Queue;
+
+	uint32 NextSerial = 1;
+
+	bool bScheduled = false;
+	FSimpleDayNightTime CurrentTime;
+	FSimpleDayNightEphemerisParams CurrentParams;
+
+	double MaxCatchUpHours = 48.0;
+
+	bool bCollapsing = false;
+
+	//Subscriptions that came due while collapsing, with the serial and time they last came due at
+	TMap<int32, TPair<uint32, FSimpleDayNightTime>> Collapsed;
+};
@@ -0,0 +1,51 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+#include "SimpleDayNightLatitudeVolume.generated.h"
+
+/**
+ * An area of the level at its own latitude. The world's USimpleDayNightSubsystem keeps a cached orientation for every
+ * region, so sun queries at a position and the sky drawn for the local view are a lookup and a blend, not a recomputation.
+ * Regions are treated as their bounding boxes.
+ */
+UCLASS()
+class SIMPLE_DAYNIGHT_API ASimpleDayNightLatitudeVolume : public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	//Latitude inside the volume. Positive for Northern Hemisphere, Negative for Southern
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(Category="Latitude", ClampMin="-90.0", ClampMax="90.0"))
+	float Latitude = 34.0f;
+
+	//Distance in from the edge of the volume over which its latitude blends in from whatever is outside it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(Category="Latitude", ClampMin="0.0", Units="cm"))
+	float BlendDistance = 10000.0f;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,85 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimpleDayNightEphemeris.h"
+
+/**
+ * Keyframe table of sky orientations for the current in-game day.
+ * Within a day the sky only depends on the time and the ephemeris params, so the orientations are evaluated once per key
+ * and sampled with a table lookup and a slerp. The next day's table is filled in a few keys at a time ahead of the rollover,
+ * and everything is rebuilt if the params change.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightOrientationCache
+{
+public:
+	//Number of keys per in-game day. More keys are more accurate but take more memory and take longer to build.
+	void SetKeysPerDay(int32 InKeysPerDay);
+
+	int32 GetKeysPerDay() const { return KeysPerDay; }
+
+	//Orientation at the given time, sampled from the table for that day. Rebuilds the table first if the day or params have changed.
+	FSimpleDayNightOrientation Sample(const FSimpleDayNightTime& Time, const FSimpleDayNightEphemerisParams& Params);
+
+	//Builds up to MaxKeys keys of the next day's table, so the day rollover doesn't have to build a whole table at once
+	void Prefetch(int32 MaxKeys);
+
+	//Throws away every table. The next Sample rebuilds from scratch.
+	void Invalidate();
+
+	//Memory used by the tables in bytes
+	SIZE_T GetAllocatedSize() const;
+
+	//Largest angle in degrees between the cached and analytic orientations of the Axis, Sun and star sphere over one day,
+	//checking SamplesPerKey times between each pair of keys.
+	static double MeasureMaxAngularError(const FSimpleDayNightEphemerisParams& Params, int64 Day, int32 KeysPerDay, int32 SamplesPerKey = 16);
+
+private:
+	struct FDayTable
+	{
+		int64 Day = 0;
+		int32 NumBuilt = 0;
+		TArray<FQuat> SunRelative;
+		TArray<FQuat> Stars;
+
+		bool IsComplete() const { return NumBuilt == SunRelative.Num() && NumBuilt > 0; }
+	};
+
+	void StartTable(FDayTable& Table, int64 Day) const;
+
+	void BuildKeys(FDayTable& Table, int32 MaxKeys) const;
+
+	FSimpleDayNightTime GetKeyTime(int64 Day, int32 Key) const;
+
+	int32 KeysPerDay = 96;
+
+	bool bValid = false;
+	FSimpleDayNightEphemerisParams CachedParams;
+
+	//The Axis only depends on the hour and latitude, so one table does for every day.
+	TArray<FQuat> Axis;
+
+	FDayTable Current;
+	FDayTable Next;
+};
@@ -0,0 +1,106 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimpleDayNightEphemeris.h"
+#include "SimpleDayNightReplicatedClock.generated.h"
+
+/**
+ * Everything a client needs to run the server's clock: the time at an epoch and the rate it runs at.
+ * Only changes when the rate changes, the time is set, or a heartbeat is due, and is quantized on the wire.
+ * Clients extrapolate from it using the synced server world time.
+ */
+USTRUCT()
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightReplicatedClock
+{
+	GENERATED_BODY()
+
+	//Clock day at the epoch
+	UPROPERTY()
+	int64 EpochDay = 0;
+
+	//Clock hour at the epoch. Sent as a 32 bit fraction of a day, so about 0.02ms of in-game time.
+	UPROPERTY()
+	double EpochHour = 0.0;
+
+	//Server world time in seconds the epoch was taken at
+	UPROPERTY()
+	double EpochServerTime = 0.0;
+
+	//Number of real-time minutes for 24 hours in-game
+	UPROPERTY()
+	float LengthOfDay = 10.0f;
+
+	//Number of in-game days a season lasts
+	UPROPERTY()
+	float SeasonLength = 5.0f;
+
+	//Bumped by the server for every warp, so clients know to play a new one. Instant warps only bump this.
+	UPROPERTY()
+	uint8 WarpSerial = 0;
+
+	//Clock time the warp that was running at the epoch lands on
+	UPROPERTY()
+	int64 WarpTargetDay = 0;
+
+	UPROPERTY()
+	double WarpTargetHour = 0.0;
+
+	//Server world time the warp that was running at the epoch lands at. 0 if there wasn't one.
+	UPROPERTY()
+	double WarpEndServerTime = 0.0;
+
+	//Whether events passed by the warp fire once each when it lands instead of on the way
+	UPROPERTY()
+	bool bCollapseWarpEvents = false;
+
+	//Whether the server has sent an epoch yet
+	bool IsValid() const { return LengthOfDay > 0.0f && EpochServerTime > 0.0; }
+
+	//Whether a timed warp was running at the epoch
+	bool IsWarping() const { return WarpEndServerTime > EpochServerTime; }
+
+	FSimpleDayNightTime GetWarpTarget() const { return FSimpleDayNightTime(WarpTargetDay, WarpTargetHour); }
+
+	//Clock time at the given server world time. Follows the warp to its target if one was running at the epoch.
+	FSimpleDayNightTime Extrapolate(double ServerTime) const;
+
+	//Number of bytes NetSerialize writes for this clock, not counting the property and bunch headers
+	int32 GetSerializedSize() const;
+
+	//Seconds a client clock that's ErrorHours behind the server should take to catch up.
+	//Errors above SnapHours are corrected at once (0), anything else is closed smoothly over CorrectionTime seconds so the sun doesn't jump.
+	static float GetCorrectionTime(double ErrorHours, float CorrectionTime, double SnapHours);
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSimpleDayNightReplicatedClock> : public TStructOpsTypeTraitsBase2<FSimpleDayNightReplicatedClock>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
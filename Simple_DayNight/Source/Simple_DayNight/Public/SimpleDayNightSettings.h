@@ -50,6 +50,36 @@ public:
 	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta= (ConsoleVariable = "sdn.TimeStep", DisplayName = "Time Step for Stepped Update",  ToolTip="Sets the frequency of sun position updates when using stepped update"))
 	float SteppedTimeRate = 1.0f;
 
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.ThresholdUpdate", DisplayName = "Use Threshold Sun Update", ToolTip="Only update the sun position once it has moved more than the Sun Angle Threshold. Overrides Smooth Sun Update"))
+	bool ThresholdUpdate = false;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.AngleThreshold", DisplayName = "Sun Angle Threshold", ClampMin = "0.0", ToolTip="How many degrees the sun has to move before its position is updated when using threshold update"))
+	float SunAngleThreshold = 0.1f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.CommitScheduler", DisplayName = "Schedule Sun Updates", ToolTip="Hold stepped and threshold sun updates back until a frame with headroom, and never update on two frames in a row. Smooths frame pacing"))
+	bool CommitScheduler = true;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.MaxDeferFrames", DisplayName = "Max Deferred Frames", ClampMin = "0", ToolTip="Maximum number of frames a sun update can be held back when scheduling sun updates"))
+	int32 MaxDeferFrames = 8;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.MaxLagAngle", DisplayName = "Max Sun Lag Angle", ClampMin = "0.0", ToolTip="Maximum number of degrees the sun may lag behind its real position before a held back update is forced"))
+	float MaxLagAngle = 1.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.CacheKeysPerDay", DisplayName = "Orientation Cache Keys Per Day", ClampMin = "0", ToolTip="Number of precomputed sun and star orientations per in-game day to interpolate between. More keys are more accurate but use more memory. 0 disables the cache"))
+	int32 OrientationCacheKeys = 96;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.TickInterval", DisplayName = "Clock Tick Interval", ClampMin = "0.0", ToolTip="Seconds between clock updates, which is how often events fire and snapshots are published. The sun and stars are still drawn for the exact time every frame. 0 updates the clock every frame"))
+	float ClockTickInterval = 0.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.SkyLightBudget", DisplayName = "SkyLight Recapture Budget", ClampMin = "0.0", ToolTip="Milliseconds a recapture of the controller's SkyLight may add to its frame. The capture resolution is adjusted to fit"))
+	float SkyLightBudget = 2.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.StarMagnitudeLimit", DisplayName = "Star Magnitude Limit", ToolTip="Faintest star drawn from the binary star catalog. Higher shows more stars"))
+	float StarMagnitudeLimit = 6.5f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Optimization", meta = (ConsoleVariable = "sdn.TickPixels", DisplayName = "Tick Pixel Threshold", ClampMin = "0.0", ToolTip="Most pixels the sky may move across the screen between DayNightController ticks. The controller works out how often to tick from how fast the sky turns, the camera's field of view and the viewport width. 0 ticks every frame"))
+	float TickPixelThreshold = 0.5f;
+
 	UPROPERTY(Config, EditAnywhere, Category = "General", meta = (ConsoleVariable="sdn.DayLength", DisplayName = "Length of Day", ToolTip="How many real-time minutes equal 24 in-game hours"))
 	float LengthOfDay = 10.0f;
 
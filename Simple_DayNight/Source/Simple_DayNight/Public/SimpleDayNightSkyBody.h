@@ -0,0 +1,55 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimpleDayNightEphemeris.h"
+#include "SimpleDayNightSkyBody.generated.h"
+
+/** A moon or planet in the sky, evaluated alongside the others in one batch on every sun commit */
+USTRUCT(BlueprintType)
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightSkyBody
+{
+	GENERATED_BODY()
+
+	//Prefix of the body's parameters in the SkyBodyCollection: <Name>Direction and <Name>Phase
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Body"))
+	FName Name = TEXT("Moon");
+
+	//In-game days for the body to lap the sun and come back to the same phase. The Moon is 29.5. 0 keeps it at PhaseOffset forever.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Body", ClampMin="0.0"))
+	float SynodicPeriod = 29.5f;
+
+	//Phase on day 0. 0 is alongside the sun (new moon), 0.5 is opposite it (full moon).
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Body", ClampMin="0.0", ClampMax="1.0"))
+	float PhaseOffset = 0.5f;
+
+	//Degrees the body's path is tilted off the sun's
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(Category="Body", ClampMin="-90.0", ClampMax="90.0"))
+	float Inclination = 5.0f;
+
+	FSimpleDayNightBodyOrbit GetOrbit() const
+	{
+		return FSimpleDayNightBodyOrbit{ SynodicPeriod, PhaseOffset, Inclination };
+	}
+};
@@ -0,0 +1,88 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FSimpleDayNightCommitScheduler;
+
+/**
+ * Decides when a managed SkyLight is recaptured. A recapture only becomes due once the sun's elevation or color has moved far
+ * enough since the last one, never starts on the frame of a sun commit or the one after, and waits for a frame with headroom.
+ * The cost of each capture is measured from the frame it lands on, and the cubemap resolution is halved or doubled to keep it within budget.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightSkyLightScheduler
+{
+public:
+	//Call on every sun commit, with the elevation in degrees and the color of the light reaching the ground
+	void NotifySunCommitted(uint64 Frame, double Elevation, const FLinearColor& Color, float ElevationThreshold, float ColorThreshold);
+
+	//Makes the next ShouldRecapture consider a recapture due, whatever the sun is doing
+	void RequestRecapture() { bRecapturePending = true; }
+
+	bool IsRecapturePending() const { return bRecapturePending; }
+
+	//Whether a recapture is waiting for its frame, or the last one still has to be measured on the frame after it
+	bool IsBusy() const { return bRecapturePending || bMeasurePending; }
+
+	//Whether to recapture on this frame. Call at the end of the frame, after any sun commit.
+	bool ShouldRecapture(const FSimpleDayNightCommitScheduler& Frames, int32 MaxDeferFrames);
+
+	//Call when the recapture has been issued
+	void NotifyRecaptured(uint64 Frame);
+
+	//Call once per frame after the frame time has been recorded. Measures the last capture and adjusts the resolution to BudgetMs.
+	void Update(const FSimpleDayNightCommitScheduler& Frames, float BudgetMs, int32 MinResolution, int32 MaxResolution);
+
+	//Cubemap resolution the next capture should use
+	int32 GetResolution() const { return Resolution; }
+	void SetResolution(int32 InResolution) { Resolution = InResolution; }
+
+	//Milliseconds the last capture added to its frame, measured against the median frame
+	float GetLastCaptureCostMs() const { return LastCaptureCostMs; }
+
+	int64 GetRecaptures() const { return Recaptures; }
+
+	//Sun commits that didn't move the sun far enough to need a recapture
+	int64 GetSkippedRecaptures() const { return SkippedRecaptures; }
+
+private:
+	bool bHasCaptured = false;
+	double CapturedElevation = 0.0;
+	FLinearColor CapturedColor = FLinearColor::Black;
+
+	bool bRecapturePending = true;
+	int32 PendingFrames = 0;
+
+	uint64 LastSunCommitFrame = 0;
+
+	//Frame the last capture was issued on. It renders at the end of that frame, so its cost shows up in the next recorded frame time.
+	uint64 CaptureFrame = 0;
+	bool bMeasurePending = false;
+
+	int32 Resolution = 128;
+	float LastCaptureCostMs = 0.0f;
+
+	int64 Recaptures = 0;
+	int64 SkippedRecaptures = 0;
+};
@@ -0,0 +1,105 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimpleDayNightEphemeris.h"
+#include <atomic>
+
+/** Immutable copy of the time and sky state, safe to hand to any thread */
+struct SIMPLE_DAYNIGHT_API FSimpleDayNightSnapshot
+{
+	FSimpleDayNightTime Time;
+
+	FSimpleDayNightEphemerisParams Params;
+
+	//In-game hours that pass per real-time second
+	double HoursPerSecond = 0.0;
+
+	//World time in seconds when the snapshot was taken
+	double WorldTime = 0.0;
+
+	//Position in the year in [0, 1). See FSimpleDayNightEphemeris::GetSeasonPhase.
+	double SeasonPhase = 0.0;
+
+	//Direction the sunlight travels
+	FVector SunDirection = FVector::ZeroVector;
+
+	//Elevation of the sun above the horizon in degrees
+	double SunElevation = 0.0;
+
+	//World rotation of the star sphere
+	FQuat StarRotation = FQuat::Identity;
+
+	//Engine frame the snapshot was taken on
+	uint64 FrameNumber = 0;
+
+	int64 GetDayIndex() const { return Time.Day; }
+
+	//Builds a snapshot from the clock and params, evaluating the sky analytically
+	static FSimpleDayNightSnapshot Make(const FSimpleDayNightTime& InTime, const FSimpleDayNightEphemerisParams& InParams, double InHoursPerSecond, double InWorldTime);
+
+	//The sky at any other time, with the same params and rate
+	FSimpleDayNightSnapshot EvaluateAt(const FSimpleDayNightTime& InTime) const;
+
+	//The sky Seconds of real time after (or before, if negative) this snapshot, assuming the rate doesn't change
+	FSimpleDayNightSnapshot Predict(double Seconds) const;
+};
+
+/**
+ * Single writer, many reader snapshot channel. The game thread publishes once per tick, and any thread can read
+ * the latest snapshot without taking a lock. Two slots, each guarded by a sequence number (seqlock style), so a reader
+ * only has to retry if the writer laps it.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightSnapshotBuffer
+{
+public:
+	//Game thread only
+	void Publish(const FSimpleDayNightSnapshot& Snapshot);
+
+	//Any thread. False if nothing has been published yet.
+	bool Read(FSimpleDayNightSnapshot& OutSnapshot) const;
+
+	//The buffer one game world's USimpleDayNightSubsystem publishes to, for code that doesn't have a world to hand
+	static FSimpleDayNightSnapshotBuffer& Get();
+
+	//Game thread only. Whether Publisher may publish to Get(). The first one to ask keeps it until ReleaseGlobal, so with several
+	//worlds (PIE with clients, or more than one PIE instance) only one of them writes to it and readers don't see the clock flip between worlds.
+	static bool ClaimGlobal(const void* Publisher);
+
+	//Game thread only. Lets the next publisher to ask have Get(), if Publisher had it.
+	static void ReleaseGlobal(const void* Publisher);
+
+private:
+	struct FSlot
+	{
+		//Odd while the slot is being written
+		std::atomic<uint32> Sequence{ 0 };
+		FSimpleDayNightSnapshot Snapshot;
+	};
+
+	FSlot Slots[2];
+
+	//Index of the slot last published to, or INDEX_NONE before the first publish
+	std::atomic<int32> Latest{ INDEX_NONE };
+};
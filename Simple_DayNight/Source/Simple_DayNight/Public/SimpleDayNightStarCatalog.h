@@ -0,0 +1,124 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Compact binary star catalog, sorted brightest first so a magnitude limit is just a prefix of the file.
+ * Made from a CSV catalog by the SimpleDayNightStarCatalog commandlet and memory mapped when loaded, so the records are
+ * never copied onto the heap where the platform can map files.
+ *
+ * Each star is 8 bytes: an octahedral encoded direction on the star sphere (two int16s), the magnitude in thousandths (int16)
+ * and the B-V color index in 40ths (int8). Directions are in the star sphere's space, with Z towards the north celestial pole
+ * and X towards right ascension 0. Stored little endian, like every platform Unreal runs on.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightStarCatalog
+{
+public:
+	struct FStar
+	{
+		FVector3f Direction = FVector3f::ZeroVector;
+		float Magnitude = 0.0f;
+		float ColorIndex = 0.0f;
+	};
+
+	FSimpleDayNightStarCatalog();
+	~FSimpleDayNightStarCatalog();
+
+	//Reads stars from CSV text. Columns are found by the header (ra, dec, mag and optionally ci or bv), or taken as
+	//RA, Dec, magnitude, color index if there's no header. RA is in hours unless bRightAscensionInDegrees. Rows that don't parse are skipped.
+	static bool ParseCsv(const FString& Csv, bool bRightAscensionInDegrees, TArray<FStar>& OutStars, FString& OutError);
+
+	//Direction on the star sphere for a right ascension and declination in degrees
+	static FVector3f GetDirection(double RightAscension, double Declination);
+
+	//Sorts the stars brightest first and writes them in the catalog format
+	static void Write(TArray<FStar> Stars, TArray<uint8>& OutBytes);
+
+	//Maps the catalog file into memory, or reads it in if the platform can't map it (like from a pak file)
+	bool Load(const FString& Filename);
+
+	//Takes over an already loaded catalog
+	bool LoadFromMemory(TArray<uint8>&& InBytes);
+
+	void Reset();
+
+	bool IsLoaded() const { return Records != nullptr; }
+
+	//Whether the records are in a mapped file rather than on the heap
+	bool IsMapped() const { return MappedRegion.IsValid(); }
+
+	int32 Num() const { return NumStars; }
+
+	FStar GetStar(int32 Index) const;
+
+	//Number of stars at or brighter than MagnitudeLimit, which are always the first ones
+	int32 GetNumBrighterThan(float MagnitudeLimit) const;
+
+	//Indices of the stars at or brighter than MagnitudeLimit that are within the cone around ViewDirection.
+	//A zero ViewDirection keeps every star under the limit.
+	void Cull(float MagnitudeLimit, const FVector3f& ViewDirection, float CosHalfAngle, TArray<int32>& OutIndices) const;
+
+	//Heap memory used by the catalog in bytes. Mapped catalogs only use address space.
+	SIZE_T GetAllocatedSize() const { return Bytes.GetAllocatedSize(); }
+
+	static constexpr uint32 Magic = 0x534E4453;
+	static constexpr uint16 Version = 1;
+
+private:
+	struct FHeader
+	{
+		uint32 Magic;
+		uint16 Version;
+		uint16 RecordSize;
+		uint32 NumStars;
+		uint32 Reserved;
+	};
+
+	struct FRecord
+	{
+		int16 DirectionX;
+		int16 DirectionY;
+		int16 Magnitude;
+		int8 ColorIndex;
+		uint8 Reserved;
+	};
+
+	static_assert(sizeof(FHeader) == 16 && sizeof(FRecord) == 8, "Star catalog layout changed");
+
+	//Checks the header and points Records at the data
+	bool Attach(const uint8* Data, int64 Size);
+
+	static FVector3f DecodeDirection(const FRecord& Record);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> Bytes;
+
+	const FRecord* Records = nullptr;
+	int32 NumStars = 0;
+};
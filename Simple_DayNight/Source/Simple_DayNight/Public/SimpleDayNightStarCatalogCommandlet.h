@@ -0,0 +1,47 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SimpleDayNightStarCatalogCommandlet.generated.h"
+
+/**
+ * Converts a CSV star catalog (like HYG) into the binary format FSimpleDayNightStarCatalog maps at runtime:
+ *
+ *   UnrealEditor-Cmd <Project> -run=SimpleDayNightStarCatalog -Input=<csv> [-Output=<file>] [-MagnitudeLimit=<n>] [-BrightestMagnitude=<n>] [-RADegrees]
+ *
+ * Stars fainter than MagnitudeLimit (default 8) are left out, as is anything brighter than BrightestMagnitude (default -2),
+ * which keeps the Sun out of catalogs that list it. RA is read as hours unless -RADegrees is given.
+ * The output defaults to Content/SimpleDayNight/Stars.sdnstars in the project.
+ */
+UCLASS()
+class USimpleDayNightStarCatalogCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USimpleDayNightStarCatalogCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
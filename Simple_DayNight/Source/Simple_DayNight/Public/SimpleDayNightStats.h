@@ -0,0 +1,53 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+//Shown with "stat sdn"
+DECLARE_STATS_GROUP(TEXT("sdn"), STATGROUP_sdn, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Controller Tick"), STAT_SimpleDayNight_ControllerTick, STATGROUP_sdn, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Clock Advance"), STAT_SimpleDayNight_Advance, STATGROUP_sdn, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Sun Position"), STAT_SimpleDayNight_UpdateSunPosition, STATGROUP_sdn, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Star Position"), STAT_SimpleDayNight_UpdateStarPosition, STATGROUP_sdn, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CVar Changed"), STAT_SimpleDayNight_CVarChanged, STATGROUP_sdn, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SkyLight Recapture"), STAT_SimpleDayNight_SkyLightRecapture, STATGROUP_sdn, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Sky Bodies"), STAT_SimpleDayNight_UpdateSkyBodies, STATGROUP_sdn, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Star Field Rebuild"), STAT_SimpleDayNight_StarFieldRebuild, STATGROUP_sdn, );
+
+//Per frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sun Commits"), STAT_SimpleDayNight_SunCommits, STATGROUP_sdn, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Skipped Sun Commits"), STAT_SimpleDayNight_SkippedSunCommits, STATGROUP_sdn, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("VSM Invalidating Transform Changes"), STAT_SimpleDayNight_TransformChanges, STATGROUP_sdn, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("SkyLight Recaptures"), STAT_SimpleDayNight_SkyLightRecaptures, STATGROUP_sdn, );
+
+//Held until the next commit or tick
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Sun Commits Per Second"), STAT_SimpleDayNight_SunCommitsPerSecond, STATGROUP_sdn, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Sun Step (degrees)"), STAT_SimpleDayNight_SunStep, STATGROUP_sdn, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Controller Ticks Per Second"), STAT_SimpleDayNight_TicksPerSecond, STATGROUP_sdn, );
+
+CSV_DECLARE_CATEGORY_EXTERN(SimpleDayNight);
@@ -0,0 +1,353 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SimpleDayNightEphemeris.h"
+#include "SimpleDayNightEventScheduler.h"
+#include "SimpleDayNightOrientationCache.h"
+#include "SimpleDayNightSnapshot.h"
+#include "SimpleDayNightTimeline.h"
+#include "SimpleDayNightSubsystem.generated.h"
+
+class ADayNightController;
+class ASimpleDayNightLatitudeVolume;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCelestialEventSignature, ECelestialEvent, Event, float, OffsetHours);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FCelestialEventDelegate, ECelestialEvent, Event, float, OffsetHours);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnWarpFinishedSignature);
+
+/** Everything the clock needs to carry on from a moment as if nothing since had happened. Cheap to take every frame for rollback. */
+struct FSimpleDayNightClockState
+{
+	FSimpleDayNightTimelineSnapshot Timeline;
+
+	float LengthOfDay = 10.0f;
+
+	//The warp that was running, if there was one
+	bool bWarping = false;
+	bool bCollapseWarpEvents = false;
+	FSimpleDayNightTime WarpStart;
+	FSimpleDayNightTime WarpTarget;
+	double WarpStartWorldTime = 0.0;
+	double WarpEndWorldTime = 0.0;
+
+	bool IsValid() const { return Timeline.IsValid(); }
+};
+
+/**
+ * Keeps the time for a world. Owns the clock, the rate it runs at and the ephemeris params, fires the celestial events
+ * and publishes the snapshots, once per frame no matter how many DayNightControllers are loaded (or none at all).
+ * Controllers register with it as presenters and just draw the sky for whatever time it says it is.
+ */
+UCLASS()
+class SIMPLE_DAYNIGHT_API USimpleDayNightSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnWarp, bool /*bFinished*/);
+	DECLARE_MULTICAST_DELEGATE(FOnClockChanged);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	//Brings the clock up to the current world time. Only the first call each frame does anything, so presenters can call it
+	//from their own tick to make sure they don't draw last frame's time.
+	void Advance();
+
+	//The current time, extrapolated from the last clock update if the tick interval is holding updates back
+	FSimpleDayNightTime GetTime() const;
+
+	//The time as of the last clock update
+	const FSimpleDayNightTime& GetClock() const { return Clock; }
+
+	//Jumps the clock. Clients get a new epoch straight away. Cancels a warp that's running.
+	void SetTime(const FSimpleDayNightTime& Time);
+
+	//Moves the clock to Target over Duration seconds of world time, or at once if Duration is 0. Events along the way fire in order,
+	//or with bCollapseEvents each one that was passed fires once when the warp lands. Presenters commit the sun once when it lands
+	//and at a capped rate on the way, instead of rebuilding shadows for every step of the sweep. Starts from wherever a running warp has got to.
+	void WarpTo(const FSimpleDayNightTime& Target, float Duration, bool bCollapseEvents);
+
+	//Whether a timed warp is running
+	UFUNCTION(BlueprintPure, meta=(Category="Time"))
+	bool IsWarping() const { return bWarping; }
+
+	const FSimpleDayNightTime& GetWarpTarget() const { return WarpTarget; }
+
+	//World time the running warp lands at
+	double GetWarpEndWorldTime() const { return WarpEndWorldTime; }
+
+	bool IsCollapsingWarpEvents() const { return bWarping && EventScheduler.IsCollapsing(); }
+
+	//Changes every time a warp starts
+	uint32 GetWarpCount() const { return WarpCount; }
+
+	//In-game hours per second the clock is moving at right now, including warps
+	double GetCurrentHoursPerSecond() const;
+
+	//Fires when a warp starts (false) and when it lands (true). Instant warps only fire when they land.
+	FOnWarp OnWarp;
+
+	//Fires when the clock is set or restored, or its rate or the ephemeris params change. Lets idle presenters know to start drawing again.
+	FOnClockChanged OnClockChanged;
+
+	//Closes a gap of ErrorHours to the server's clock over CorrectionTime seconds (at once with 0) without counting as a jump.
+	//Used by clients once per clock update from the server. Not for while a warp is running, it would replace the warp's landing.
+	void CorrectClock(double ErrorHours, float CorrectionTime);
+
+	//Changes every time the clock is jumped with SetTime
+	uint32 GetClockGeneration() const { return ClockGeneration; }
+
+	//Every rate change, jump and warp of the last minute or so, in fixed point. The clock at any world tick in that time can be sampled from it.
+	const FSimpleDayNightTimeline& GetTimeline() const { return Timeline; }
+
+	//The clock as it is now, to restore later. Only copies the current segment (and the end of a warp if one's running).
+	FSimpleDayNightClockState SaveClockState() const;
+
+	//Puts the clock back how it was when State was saved, dropping any rate changes, jumps or warps since. The clock carries
+	//on from the current world time as if they never happened. Counts as a jump, so clients get a new epoch.
+	void RestoreClockState(const FSimpleDayNightClockState& State);
+
+	float GetLengthOfDay() const { return LengthOfDay; }
+	void SetLengthOfDay(float InLengthOfDay);
+
+	//In-game hours that pass per second of world time
+	double GetHoursPerSecond() const { return LengthOfDay > 0.0f ? 24.0 / LengthOfDay / 60.0 : 0.0; }
+
+	const FSimpleDayNightEphemerisParams& GetEphemerisParams() const { return Params; }
+	void SetEphemerisParams(const FSimpleDayNightEphemerisParams& InParams);
+
+	float GetTickInterval() const { return TickInterval; }
+	void SetTickInterval(float InTickInterval) { TickInterval = FMath::Max(InTickInterval, 0.0f); }
+
+	//Time of Day in hours. 24hr clock, doesn't wrap, the same as the DayNightController's Time Of Day.
+	UFUNCTION(BlueprintPure, meta=(Category="Time"))
+	double GetTimeOfDay() const;
+
+	UFUNCTION(BlueprintCallable, meta=(Category="Time"))
+	void SetTimeOfDay(double InTimeOfDay);
+
+	//Warps to the given Time of Day over Duration seconds, or at once if Duration is 0
+	UFUNCTION(BlueprintCallable, meta=(Category="Time"))
+	void WarpToTimeOfDay(double InTimeOfDay, float Duration, bool bCollapseEvents = false);
+
+	//Warps Hours in-game hours ahead over Duration seconds, or at once if Duration is 0
+	UFUNCTION(BlueprintCallable, meta=(Category="Time"))
+	void WarpForward(double Hours, float Duration, bool bCollapseEvents = false);
+
+	//Warps to the next Event, plus OffsetHours, over Duration seconds. False if it doesn't happen within a year.
+	UFUNCTION(BlueprintCallable, meta=(Category="Time"))
+	bool WarpToCelestialEvent(ECelestialEvent Event, float OffsetHours, float Duration, bool bCollapseEvents = false);
+
+	//Fires when a warp lands
+	UPROPERTY(BlueprintAssignable, meta=(Category="Time"))
+	FOnWarpFinishedSignature OnWarpFinished;
+
+	//Direction the sunlight travels at the current time
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	FVector GetSunDirection() const;
+
+	//Elevation of the sun above the horizon in degrees at the current time
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	double GetSunElevation() const;
+
+	//Direction the sunlight travels at WorldPosition, blended from the latitude regions around it as of the last clock update.
+	//A grid lookup and a blend of cached directions, so it costs the same however many players ask.
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	FVector GetSunDirectionAt(const FVector& WorldPosition) const;
+
+	//Elevation of the sun above the horizon in degrees at WorldPosition, as of the last clock update
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	double GetSunElevationAt(const FVector& WorldPosition) const;
+
+	//Latitude at WorldPosition, blended from the latitude regions around it the same way as the sun
+	UFUNCTION(BlueprintPure, meta=(Category="Sun"))
+	float GetLatitudeAt(const FVector& WorldPosition) const;
+
+	//Direction the sunlight travels at WorldPosition at exactly Time, evaluated for each region around it
+	FVector EvaluateSunDirectionAt(const FVector& WorldPosition, const FSimpleDayNightTime& Time) const;
+
+	//Blends the orientations of the regions around WorldPosition at Time, from their orientation caches, into InOutOrientation.
+	//InOutOrientation should be the orientation for the world's own latitude, which is what's left outside every region.
+	void BlendRegionOrientation(const FVector& WorldPosition, const FSimpleDayNightTime& Time, FSimpleDayNightOrientation& InOutOrientation);
+
+	//Called by latitude volumes from BeginPlay and EndPlay
+	void RegisterRegion(ASimpleDayNightLatitudeVolume* Volume);
+	void UnregisterRegion(ASimpleDayNightLatitudeVolume* Volume);
+
+	int32 GetNumRegions() const { return Regions.Num(); }
+
+	//Fires at every sunrise, sunset, noon, midnight, solstice and equinox. Use BindCelestialEvent to be told ahead of or after an event.
+	UPROPERTY(BlueprintAssignable, meta=(Category="Events"))
+	FOnCelestialEventSignature OnCelestialEvent;
+
+	//Calls Delegate OffsetHours in-game hours after every Event. Use a negative offset for before, e.g. -0.5 and Sunset for half an hour before sunset.
+	UFUNCTION(BlueprintCallable, meta=(Category="Events"))
+	void BindCelestialEvent(ECelestialEvent Event, float OffsetHours, FCelestialEventDelegate Delegate);
+
+	//Removes every binding of Delegate made with BindCelestialEvent
+	UFUNCTION(BlueprintCallable, meta=(Category="Events"))
+	void UnbindCelestialEvent(FCelestialEventDelegate Delegate);
+
+	//In-game hours until the next Event, or -1 if it doesn't happen within a year (like sunrise in polar night)
+	UFUNCTION(BlueprintPure, meta=(Category="Events"))
+	double GetHoursUntilCelestialEvent(ECelestialEvent Event) const;
+
+	FSimpleDayNightEventScheduler& GetEventScheduler() { return EventScheduler; }
+
+	//Snapshots of this world's time and sky state. Read from any thread without locking.
+	const FSimpleDayNightSnapshotBuffer& GetSnapshotBuffer() const { return SnapshotBuffer; }
+
+	//The controller whose settings drive the clock, or null if none is loaded
+	UFUNCTION(BlueprintPure, meta=(Category="Time"))
+	ADayNightController* GetPrimaryController() const;
+
+	//Called by controllers from BeginPlay. Returns whether Controller is now the primary.
+	bool RegisterPresenter(ADayNightController* Controller);
+
+	//Called by controllers from EndPlay. If Controller was the primary, the next registered controller takes over.
+	void UnregisterPresenter(ADayNightController* Controller);
+
+	bool IsPrimaryPresenter(const ADayNightController* Controller) const;
+
+	//Whether any controller has registered in this world yet. The first one sets the starting time and settings,
+	//controllers loaded later (like when streamed back in) take on the world's current state instead.
+	bool HasHadPresenter() const { return bHadPresenter; }
+
+protected:
+	//Samples the timeline at the current world time into the clock
+	void Rebase();
+
+	double GetWorldTime() const;
+
+	int64 GetWorldTick() const { return FSimpleDayNightTimeline::ToWorldTicks(GetWorldTime()); }
+
+	//Clock ticks per second for the length of day
+	int64 GetRate() const { return FSimpleDayNightTimeline::ToRate(GetHoursPerSecond()); }
+
+	//Clock time at the given world time, following a running warp
+	FSimpleDayNightTime EvaluateClock(double WorldTime) const;
+
+	//Sets up the warp state for a warp from the current clock to Target. The timeline's segments are up to the caller.
+	void BeginWarp(const FSimpleDayNightTime& Target, bool bCollapseEvents);
+
+	//Fires the rest of the warp's events, ends it and tells everyone it landed
+	void FinishWarp();
+
+	//Stops the warp without landing it, putting the event scheduler back how it was
+	void EndWarp();
+
+	void BroadcastCelestialEvent(ECelestialEvent Event, double OffsetHours);
+
+	void PublishSnapshot();
+
+	struct FLatitudeRegion
+	{
+		TWeakObjectPtr<ASimpleDayNightLatitudeVolume> Volume;
+		FBox Bounds;
+		double Area = 0.0;
+		float BlendDistance = 0.0f;
+		FSimpleDayNightEphemerisParams Params;
+		FSimpleDayNightOrientationCache Cache;
+
+		//False if the controllers have the orientation cache turned off, in which case the region evaluates directly too
+		bool bCached = true;
+
+		//Sun direction at the last clock update
+		FVector SunDirection = FVector::ZeroVector;
+	};
+
+	//Indices of the regions at a position and how much each counts
+	typedef TArray<TPair<int32, float>, TInlineAllocator<4>> FRegionWeights;
+
+	//Fills OutWeights with the regions at WorldPosition and returns the weight left over for the world's own latitude.
+	//Smaller regions sit on top of bigger ones, so a region inside another one takes over from it.
+	float GetRegionWeights(const FVector& WorldPosition, FRegionWeights& OutWeights) const;
+
+	//Updates every region's sun direction for the current clock
+	void UpdateRegions();
+
+	static FIntPoint GetRegionCell(const FVector& WorldPosition);
+
+	//The time as of the last clock update, sampled from the timeline
+	FSimpleDayNightTime Clock = FSimpleDayNightTime::FromHours(6.0);
+
+	//Where the clock actually comes from
+	FSimpleDayNightTimeline Timeline;
+
+	FSimpleDayNightEphemerisParams Params;
+
+	//Number of real-time minutes for 24 hours in-game
+	float LengthOfDay = 10.0f;
+
+	//Seconds of world time between clock updates. 0 updates every frame.
+	float TickInterval = 0.0f;
+
+	uint32 ClockGeneration = 0;
+
+	//World time and frame of the last clock update
+	double LastAdvanceWorldTime = 0.0;
+	uint64 LastAdvanceFrame = MAX_uint64;
+
+	FSimpleDayNightEventScheduler EventScheduler;
+
+	FSimpleDayNightSnapshotBuffer SnapshotBuffer;
+
+	//Delegates bound from Blueprint with BindCelestialEvent and their handles in the event scheduler
+	TArray<TPair<FCelestialEventDelegate, FDelegateHandle>> BoundCelestialEvents;
+
+	//The running warp, straight from WarpStart at WarpStartWorldTime to WarpTarget at WarpEndWorldTime. The timeline has a segment for each end.
+	bool bWarping = false;
+	FSimpleDayNightTime WarpStart;
+	FSimpleDayNightTime WarpTarget;
+	double WarpStartWorldTime = 0.0;
+	double WarpEndWorldTime = 0.0;
+	uint32 WarpCount = 0;
+
+	//The event scheduler's catch up limit from before the warp raised it
+	double SavedMaxCatchUpHours = 0.0;
+
+	TSparseArray<FLatitudeRegion> Regions;
+
+	//Regions overlapping each grid cell, so finding the ones at a position doesn't depend on how many there are
+	TMap<FIntPoint, TArray<int32>> RegionGrid;
+
+	//Regions covering too many cells to be worth putting in the grid. Checked at every position.
+	TArray<int32> LargeRegions;
+
+	//Sun direction for the world's own latitude at the last clock update
+	FVector BaseSunDirection = FVector::ZeroVector;
+
+	//Registered controllers in the order they registered. The first is the primary.
+	TArray<TWeakObjectPtr<ADayNightController>> Presenters;
+
+	//Set once any controller has registered, after which new controllers adopt the clock instead of setting it
+	bool bHadPresenter = false;
+};
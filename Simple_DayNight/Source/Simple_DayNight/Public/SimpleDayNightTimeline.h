@@ -0,0 +1,126 @@
+//MIT License
+//
+//Copyright(c) 2024 David Lejeune
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files(the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions :
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SimpleDayNightEphemeris.h"
+
+/** A stretch of the clock running at one rate, from WorldTick until the next segment starts */
+struct FSimpleDayNightClockSegment
+{
+	//World time the segment starts at, in world ticks
+	int64 WorldTick = 0;
+
+	//Clock time at WorldTick, in clock ticks
+	int64 ClockTick = 0;
+
+	//Clock ticks per second of world time
+	int64 Rate = 0;
+
+	bool operator==(const FSimpleDayNightClockSegment& Other) const { return WorldTick == Other.WorldTick && ClockTick == Other.ClockTick && Rate == Other.Rate; }
+	bool operator!=(const FSimpleDayNightClockSegment& Other) const { return !(*this == Other); }
+};
+
+/** The part of a timeline that's in effect from some world time on. Restoring it puts the timeline back how it was then. */
+struct FSimpleDayNightTimelineSnapshot
+{
+	//The segment in effect when the snapshot was taken, then any that were already lined up after it (the end of a warp)
+	TArray<FSimpleDayNightClockSegment, TInlineAllocator<2>> Segments;
+
+	bool IsValid() const { return Segments.Num() > 0; }
+};
+
+/**
+ * Fixed-point clock. World time and clock time are both whole microseconds, and every rate change, jump or warp is
+ * recorded as a segment, so the clock at any world time is a pure function of the segments found with a binary search.
+ * Nothing is added up frame by frame, so two machines (or a replay) running at different frame rates read the same
+ * clock at the same world time, and events land on the same tick.
+ */
+class SIMPLE_DAYNIGHT_API FSimpleDayNightTimeline
+{
+public:
+	//World ticks per second of world time
+	static constexpr int64 WorldTicksPerSecond = 1000000;
+
+	//Clock ticks per in-game hour, so a clock tick is an in-game microsecond
+	static constexpr int64 ClockTicksPerHour = 3600000000;
+	static constexpr int64 ClockTicksPerDay = ClockTicksPerHour * 24;
+
+	static int64 ToWorldTicks(double Seconds);
+	static int64 ToClockTicks(const FSimpleDayNightTime& Time);
+	static FSimpleDayNightTime ToTime(int64 ClockTick);
+
+	//Clock ticks per second of world time for a rate in in-game hours per second
+	static int64 ToRate(double HoursPerSecond);
+	static double ToHoursPerSecond(int64 Rate) { return (double)Rate / ClockTicksPerHour; }
+
+	//Clock ticks per second that covers ClockTicks in WorldTicks
+	static int64 GetRateToCover(int64 ClockTicks, int64 WorldTicks);
+
+	//A*B/C without overflowing on the way, as long as C * Min(B, C) fits in an int64. Rounds toward zero like plain integer division.
+	static int64 MulDiv(int64 A, int64 B, int64 C);
+
+	//Throws away every segment and starts over with one
+	void Reset(int64 WorldTick, int64 ClockTick, int64 Rate);
+
+	//Runs the clock from ClockTick at Rate from WorldTick on, replacing any segments at or after WorldTick.
+	//Does nothing if the clock would already be doing exactly that.
+	void AddSegment(int64 WorldTick, int64 ClockTick, int64 Rate);
+
+	//Changes the rate from WorldTick on without moving the clock
+	void SetRate(int64 WorldTick, int64 Rate);
+
+	//Moves the clock by ClockTicks from WorldTick on, keeping any segments lined up after it (so a running warp still lands on time, just shifted)
+	void Offset(int64 WorldTick, int64 ClockTicks);
+
+	//Closes a gap of ClockTicks by running a little faster or slower for SlewWorldTicks, then carries on at Rate. At most two segments,
+	//however often it's called. With no SlewWorldTicks it jumps. A clock that's ahead slows to no less than half of Rate, taking longer if it
+	//has to, rather than running backwards. Replaces any segments at or after WorldTick, like AddSegment.
+	void Slew(int64 WorldTick, int64 ClockTicks, int64 SlewWorldTicks, int64 Rate);
+
+	//Clock ticks at WorldTick. Before the first segment, the first segment is run backwards.
+	int64 Sample(int64 WorldTick) const;
+
+	FSimpleDayNightTime SampleTime(int64 WorldTick) const { return ToTime(Sample(WorldTick)); }
+
+	//The segment in effect at WorldTick
+	const FSimpleDayNightClockSegment& GetSegment(int64 WorldTick) const { return Segments[FindSegment(WorldTick)]; }
+
+	//Drops the history from before WorldTick, keeping the segment in effect at it
+	void TrimBefore(int64 WorldTick);
+
+	//Everything needed to put the timeline back how it is from WorldTick on
+	FSimpleDayNightTimelineSnapshot Snapshot(int64 WorldTick) const;
+
+	//Puts the timeline back how it was when the snapshot was taken, dropping everything that's been recorded from then on
+	void Restore(const FSimpleDayNightTimelineSnapshot& InSnapshot);
+
+	int32 Num() const { return Segments.Num(); }
+	const TArray<FSimpleDayNightClockSegment>& GetSegments() const { return Segments; }
+
+private:
+	//Index of the segment in effect at WorldTick
+	int32 FindSegment(int64 WorldTick) const;
+
+	//Sorted by world tick, never empty
+	TArray<FSimpleDayNightClockSegment> Segments = { FSimpleDayNightClockSegment() };
+};
@@ -38,7 +38,8 @@ public class Simple_DayNight : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
-				"DeveloperSettings"
+				"DeveloperSettings",
+				"Json"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);